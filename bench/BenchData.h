@@ -0,0 +1,104 @@
+#pragma once
+#include <cstdint>
+#include <random>
+#include <vector>
+#include "../include/ISet.h"
+#include "../include/IVector.h"
+#include "../src/Kernels.h"
+
+/*
+* Inputs shared by the benchmarks, generated from fixed seeds so that two runs measure the same data
+*/
+namespace bench {
+
+constexpr uint64_t seed = 42;
+
+/*
+* `count` coordinates uniform in [-1, 1)
+*/
+inline std::vector<double> uniform(size_t count, uint64_t salt = 0) {
+    std::mt19937_64 random(seed + salt);
+    std::uniform_real_distribution<double> cord(-1, 1);
+    std::vector<double> data(count);
+    for (double& val : data) {
+        val = cord(random);
+    }
+    return data;
+}
+
+/*
+* `rows` vectors of `dim` coordinates spread normally with deviation `spread` around `clusters` centers,
+* the centers are uniform in [-1, 1)
+*/
+inline std::vector<double> clustered(size_t rows, size_t dim, size_t clusters, double spread, uint64_t salt = 0) {
+    std::vector<double> centers = uniform(clusters * dim, salt + 1);
+    std::mt19937_64 random(seed + salt);
+    std::normal_distribution<double> offset(0, spread);
+    std::uniform_int_distribution<size_t> pick(0, clusters - 1);
+    std::vector<double> data(rows * dim);
+    for (size_t i = 0; i < rows; i++) {
+        double const* center = centers.data() + pick(random) * dim;
+        for (size_t j = 0; j < dim; j++) {
+            data[i * dim + j] = center[j] + offset(random);
+        }
+    }
+    return data;
+}
+
+/*
+* Vectors made of consecutive `dim` coordinates of `data`, owned by the caller
+*/
+inline std::vector<IVector*> vectors(std::vector<double> const& data, size_t dim) {
+    std::vector<IVector*> res;
+    for (size_t i = 0; i + dim <= data.size(); i += dim) {
+        res.push_back(IVector::createVector(dim, data.data() + i));
+    }
+    return res;
+}
+
+inline void release(std::vector<IVector*>& vecs) {
+    for (IVector* vec : vecs) {
+        delete vec;
+    }
+    vecs.clear();
+}
+
+/*
+* Set of the rows of `data` inserted one by one, nullptr if any insert fails
+*/
+inline ISet* makeSet(std::vector<double> const& data, size_t dim, IVector::NORM n, double tol,
+    ISet::INDEX index = ISet::INDEX::KD_TREE, ISet::PRECISION precision = ISet::PRECISION::FLOAT64) {
+    ISet* set = ISet::createSet(nullptr, precision);
+    if (!set || set->setIndex(index) != RC::SUCCESS) {
+        delete set;
+        return nullptr;
+    }
+    set->reserve(data.size() / dim);
+    for (size_t i = 0; i + dim <= data.size(); i += dim) {
+        IVector const* vec = IVector::createVector(dim, data.data() + i);
+        RC code = vec ? set->insert(vec, n, tol) : RC::ALLOCATION_ERROR;
+        delete vec;
+        if (code != RC::SUCCESS) {
+            delete set;
+            return nullptr;
+        }
+    }
+    return set;
+}
+
+inline const char* normName(IVector::NORM n) {
+    static const char* names[] = { "CHEBYSHEV", "FIRST", "SECOND" };
+    return n < IVector::NORM::AMOUNT ? names[(int)n] : "UNKNOWN";
+}
+
+inline const char* isaName(kernels::ISA isa) {
+    static const char* names[] = { "SCALAR", "SSE2", "AVX2", "AVX512" };
+    return isa < kernels::ISA::AMOUNT ? names[(int)isa] : "UNKNOWN";
+}
+
+inline const char* indexName(ISet::INDEX index) {
+    static const char* names[] = { "LINEAR", "GRID", "KD_TREE", "SORTED" };
+    return index < ISet::INDEX::AMOUNT ? names[(int)index] : "UNKNOWN";
+}
+
+}
@@ -0,0 +1,47 @@
+#include <benchmark/benchmark.h>
+#include <cstdio>
+#include <cstring>
+#include <vector>
+#include "../src/Kernels.h"
+#include "BenchData.h"
+
+/*
+* Entry point of vector_bench
+*
+* Usage: vector_bench [google benchmark flags], results are printed as JSON unless --benchmark_format is given
+* Build with -DCMAKE_BUILD_TYPE=Release and compare two runs with bench/compare.py
+*/
+int main(int argc, char** argv) {
+    // JSON is the default output, so that runs can be compared without extra flags
+    std::vector<char*> args(argv, argv + argc);
+    bool hasFormat = false;
+    for (int i = 1; i < argc; i++) {
+        hasFormat = hasFormat || strncmp(argv[i], "--benchmark_format", strlen("--benchmark_format")) == 0;
+    }
+    char jsonFormat[] = "--benchmark_format=json";
+    if (!hasFormat) {
+        args.push_back(jsonFormat);
+    }
+    int count = (int)args.size();
+    benchmark::Initialize(&count, args.data());
+    if (benchmark::ReportUnrecognizedArguments(count, args.data())) {
+        return 1;
+    }
+
+    benchmark::AddCustomContext("kernels_isa", bench::isaName(kernels::getIsa()));
+#ifdef FAST_MATH
+    benchmark::AddCustomContext("fast_math", "true");
+#else
+    benchmark::AddCustomContext("fast_math", "false");
+#endif
+#if defined(__OPTIMIZE__) || (defined(_MSC_VER) && defined(NDEBUG))
+    benchmark::AddCustomContext("optimized", "true");
+#else
+    benchmark::AddCustomContext("optimized", "false");
+    fprintf(stderr, "***WARNING*** vector_bench was built without optimization, configure with -DCMAKE_BUILD_TYPE=Release\n");
+#endif
+
+    benchmark::RunSpecifiedBenchmarks();
+    benchmark::Shutdown();
+    return 0;
+}
@@ -0,0 +1,103 @@
+#include <benchmark/benchmark.h>
+#include <cstdio>
+#include "../include/ILogger.h"
+
+/*
+* Cost of one log call as seen by the caller, from a call the macros skip to a record formatted and written
+* Text loggers write to the null device, so the disk isn't measured
+*/
+
+#ifdef _WIN32
+static const char* const nullDevice = "NUL";
+#else
+static const char* const nullDevice = "/dev/null";
+#endif
+
+static const char* const binaryLog = "vector_bench.binlog";
+
+enum class Kind {
+    NONE,   // Macro with a null logger
+    LEVEL,  // Record below the logger level
+    TEXT,   // Logger
+    ASYNC,  // Async logger dropping records when its queue is full
+    BLOCK,  // Async logger waiting for room in its queue
+    BINARY  // Binary logger
+};
+
+static ILogger* makeLogger(Kind kind) {
+    switch (kind) {
+    case Kind::LEVEL: {
+        ILogger* logger = ILogger::createLogger(nullDevice);
+        logger->setLevel(ILogger::Level::SEVER);
+        return logger;
+    }
+    case Kind::TEXT:
+        return ILogger::createLogger(nullDevice);
+    case Kind::ASYNC:
+        return ILogger::createAsyncLogger(nullDevice, true, ILogger::Overflow::DROP);
+    case Kind::BLOCK:
+        return ILogger::createAsyncLogger(nullDevice, true, ILogger::Overflow::BLOCK);
+    case Kind::BINARY:
+        return ILogger::createBinaryLogger(binaryLog);
+    default:
+        return nullptr;
+    }
+}
+
+static const char* kindName(Kind kind) {
+    static const char* names[] = { "none", "level", "text", "async drop", "async block", "binary" };
+    return names[(int)kind];
+}
+
+/*
+* All threads of a run share one logger, thread 0 creates it before the timed loop and deletes it after
+*/
+static ILogger* shared = nullptr;
+
+static void BM_SendWarning(benchmark::State& state) {
+    Kind kind = (Kind)state.range(0);
+    if (state.thread_index() == 0) {
+        shared = makeLogger(kind);
+        if (kind != Kind::NONE && !shared) {
+            state.SkipWithError("logger can't be created");
+        }
+    }
+    for (auto _ : state) {
+        SendWarning(shared, RC::INVALID_ARGUMENT);
+    }
+    if (state.thread_index() == 0) {
+        // queued records are written outside the timed loop
+        if (shared) {
+            shared->flush();
+        }
+        delete shared;
+        shared = nullptr;
+        std::remove(binaryLog);
+    }
+    state.SetLabel(kindName(kind));
+}
+BENCHMARK(BM_SendWarning)->DenseRange((int64_t)Kind::NONE, (int64_t)Kind::TEXT)->ArgName("logger");
+BENCHMARK(BM_SendWarning)
+    ->Arg((int64_t)Kind::ASYNC)->Arg((int64_t)Kind::BLOCK)->ArgName("logger")
+    ->Threads(1)->Threads(4)->UseRealTime();
+// the file has room for 2^21 records, later ones would measure the full-file path
+BENCHMARK(BM_SendWarning)->Arg((int64_t)Kind::BINARY)->ArgName("logger")->Iterations(1 << 20);
+
+/*
+* Same record over and over with coalescing or a rate limit, nearly all of them are never written
+*/
+static void BM_SendWarningFiltered(benchmark::State& state) {
+    bool coalesce = state.range(0) != 0;
+    ILogger* logger = ILogger::createLogger(nullDevice);
+    if (coalesce) {
+        logger->setCoalescing(true);
+    } else {
+        logger->setRateLimit(100);
+    }
+    for (auto _ : state) {
+        SendWarning(logger, RC::INVALID_ARGUMENT);
+    }
+    state.SetLabel(coalesce ? "coalescing" : "rate limit");
+    delete logger;
+}
+BENCHMARK(BM_SendWarningFiltered)->Arg(0)->Arg(1)->ArgName("coalesce");
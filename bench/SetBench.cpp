@@ -0,0 +1,553 @@
+#include <benchmark/benchmark.h>
+#include <atomic>
+#include <mutex>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+#include "../include/FixedSet.h"
+#include "../include/ISet.h"
+#include "../include/IVectorView.h"
+#include "BenchData.h"
+
+/*
+* Set insertion, lookups and removal across sizes, norms, indices and remove modes, plus the batched queries
+*
+* Unless stated otherwise vectors are 3-dimensional, uniform in [-1, 1)^3 and inserted with tol = 1e-3, so that
+* nearly all of them are kept
+*/
+
+constexpr size_t dim = 3;
+constexpr double tol = 1e-3;
+
+static const std::vector<int64_t> norms = { (int64_t)IVector::NORM::CHEBYSHEV, (int64_t)IVector::NORM::FIRST, (int64_t)IVector::NORM::SECOND };
+static const std::vector<int64_t> indices = { (int64_t)ISet::INDEX::LINEAR, (int64_t)ISet::INDEX::GRID, (int64_t)ISet::INDEX::KD_TREE, (int64_t)ISet::INDEX::SORTED };
+
+/*
+* Linear scans of 100000 vectors make insert() and findFirst() quadratic, they are measured up to 10000
+*/
+static void sizesNormsIndices(benchmark::internal::Benchmark* bm) {
+    bm->ArgNames({ "size", "norm", "index" });
+    for (int64_t size : { 1000, 10000, 100000 }) {
+        for (int64_t norm : norms) {
+            for (int64_t index : indices) {
+                if (size <= 10000 || index != (int64_t)ISet::INDEX::LINEAR) {
+                    bm->Args({ size, norm, index });
+                }
+            }
+        }
+    }
+}
+
+/*
+* Patterns for findFirst(): every other one is a stored vector moved by tol / 10, the rest are fresh points
+*/
+static std::vector<IVector*> patterns(std::vector<double> const& data, size_t count) {
+    std::vector<double> fresh = bench::uniform(count * dim, 1);
+    std::vector<double> cords(count * dim);
+    size_t stored = data.size() / dim;
+    for (size_t i = 0; i < count; i++) {
+        for (size_t j = 0; j < dim; j++) {
+            cords[i * dim + j] = i % 2 == 0 ? data[(i * 7919 % stored) * dim + j] + tol / 10 : fresh[i * dim + j];
+        }
+    }
+    return bench::vectors(cords, dim);
+}
+
+static void setLabel(benchmark::State& state, IVector::NORM n, ISet::INDEX index) {
+    state.SetLabel(std::string(bench::normName(n)) + "/" + bench::indexName(index));
+}
+
+/*
+* Whole set is built each iteration, time per vector is iteration time / size
+*/
+static void BM_SetInsert(benchmark::State& state) {
+    size_t size = (size_t)state.range(0);
+    IVector::NORM n = (IVector::NORM)state.range(1);
+    ISet::INDEX index = (ISet::INDEX)state.range(2);
+    std::vector<double> data = bench::uniform(size * dim);
+    std::vector<IVector*> vecs = bench::vectors(data, dim);
+    for (auto _ : state) {
+        ISet* set = ISet::createSet(nullptr);
+        set->setIndex(index);
+        for (IVector const* vec : vecs) {
+            set->insert(vec, n, tol);
+        }
+        benchmark::DoNotOptimize(set);
+        state.PauseTiming();
+        delete set;
+        state.ResumeTiming();
+    }
+    state.SetItemsProcessed((int64_t)(state.iterations() * size));
+    setLabel(state, n, index);
+    bench::release(vecs);
+}
+BENCHMARK(BM_SetInsert)->Apply(sizesNormsIndices)->Unit(benchmark::kMillisecond);
+
+/*
+* Same with storage reserved up front, the difference is the cost of growing
+*/
+static void BM_SetInsertReserved(benchmark::State& state) {
+    size_t size = (size_t)state.range(0);
+    std::vector<double> data = bench::uniform(size * dim);
+    std::vector<IVector*> vecs = bench::vectors(data, dim);
+    for (auto _ : state) {
+        ISet* set = ISet::createSet(nullptr);
+        set->reserve(size);
+        for (IVector const* vec : vecs) {
+            set->insert(vec, IVector::NORM::SECOND, tol);
+        }
+        benchmark::DoNotOptimize(set);
+        state.PauseTiming();
+        delete set;
+        state.ResumeTiming();
+    }
+    state.SetItemsProcessed((int64_t)(state.iterations() * size));
+    bench::release(vecs);
+}
+BENCHMARK(BM_SetInsertReserved)->Arg(1000)->Arg(10000)->Arg(100000)->ArgName("size")->Unit(benchmark::kMillisecond);
+
+/*
+* Same vectors as BM_SetInsert loaded by one insertBatch(), linear index included at all sizes
+* 4 threads are meaningful only on a machine with that many cores
+*/
+static void BM_SetInsertBatch(benchmark::State& state) {
+    size_t size = (size_t)state.range(0);
+    ISet::INDEX index = (ISet::INDEX)state.range(1);
+    std::vector<double> data = bench::uniform(size * dim);
+    ISet::setThreadCount((size_t)state.range(2));
+    for (auto _ : state) {
+        ISet* set = ISet::createSet(nullptr);
+        set->setIndex(index);
+        set->insertBatch(data.data(), dim, size, IVector::NORM::SECOND, tol);
+        benchmark::DoNotOptimize(set);
+        state.PauseTiming();
+        delete set;
+        state.ResumeTiming();
+    }
+    ISet::setThreadCount(1);
+    state.SetItemsProcessed((int64_t)(state.iterations() * size));
+    setLabel(state, IVector::NORM::SECOND, index);
+}
+BENCHMARK(BM_SetInsertBatch)
+    ->ArgsProduct({ { 1000, 10000, 100000 }, indices, { 1, 4 } })
+    ->ArgNames({ "size", "index", "threads" })
+    ->Unit(benchmark::kMillisecond)
+    ->UseRealTime();
+
+static void BM_SetFindFirst(benchmark::State& state) {
+    size_t size = (size_t)state.range(0);
+    IVector::NORM n = (IVector::NORM)state.range(1);
+    ISet::INDEX index = (ISet::INDEX)state.range(2);
+    std::vector<double> data = bench::uniform(size * dim);
+    ISet* set = bench::makeSet(data, dim, n, tol, index);
+    std::vector<IVector*> pats = patterns(data, 1024);
+    size_t next = 0;
+    for (auto _ : state) {
+        IVector const* found = nullptr;
+        if (set->findFirst(pats[next++ % pats.size()], n, tol, found) == RC::SUCCESS) {
+            delete found;
+        }
+    }
+    setLabel(state, n, index);
+    bench::release(pats);
+    delete set;
+}
+BENCHMARK(BM_SetFindFirst)->Apply(sizesNormsIndices);
+
+/*
+* findFirst() copies the found vector, findFirstView() points into storage
+*/
+static void BM_SetFindFirstView(benchmark::State& state) {
+    size_t size = (size_t)state.range(0);
+    std::vector<double> data = bench::uniform(size * dim);
+    ISet* set = bench::makeSet(data, dim, IVector::NORM::SECOND, tol);
+    std::vector<IVector*> pats = patterns(data, 1024);
+    size_t next = 0;
+    for (auto _ : state) {
+        IVectorView view;
+        set->findFirstView(pats[next++ % pats.size()], IVector::NORM::SECOND, tol, view);
+        benchmark::DoNotOptimize(view);
+    }
+    bench::release(pats);
+    delete set;
+}
+BENCHMARK(BM_SetFindFirstView)->Arg(1000)->Arg(100000)->ArgName("size");
+
+/*
+* findAll() within 0.01 on 2D and 3D point clouds, uniform or in 64 clusters of deviation 0.05, loaded by
+* insertBatch() with tol = 1e-9, patterns drawn the same way as the points
+*/
+static void BM_SetPointCloud(benchmark::State& state) {
+    size_t size = (size_t)state.range(0);
+    size_t cloudDim = (size_t)state.range(1);
+    bool clustered = state.range(2) != 0;
+    ISet::INDEX index = (ISet::INDEX)state.range(3);
+    std::vector<double> data = clustered ? bench::clustered(size, cloudDim, 64, 0.05) : bench::uniform(size * cloudDim);
+    ISet* set = ISet::createSet(nullptr);
+    set->setIndex(index);
+    set->insertBatch(data.data(), cloudDim, size, IVector::NORM::SECOND, 1e-9);
+    std::vector<IVector*> pats = bench::vectors(clustered ? bench::clustered(1024, cloudDim, 64, 0.05, 4) : bench::uniform(1024 * cloudDim, 4), cloudDim);
+    std::vector<size_t> found;
+    size_t next = 0;
+    for (auto _ : state) {
+        set->findAll(pats[next++ % pats.size()], IVector::NORM::SECOND, 0.01, found);
+        benchmark::DoNotOptimize(found.data());
+    }
+    state.SetLabel(std::string(clustered ? "clustered" : "uniform") + "/" + bench::indexName(index));
+    bench::release(pats);
+    delete set;
+}
+BENCHMARK(BM_SetPointCloud)
+    ->ArgsProduct({ { 10000, 100000 }, { 2, 3 }, { 0, 1 }, indices })
+    ->ArgNames({ "size", "dim", "clustered", "index" });
+
+/*
+* Half of the vectors are removed by index each iteration, picked at random
+*/
+static void BM_SetRemove(benchmark::State& state) {
+    size_t size = (size_t)state.range(0);
+    ISet::REMOVE_MODE mode = (ISet::REMOVE_MODE)state.range(1);
+    ISet::INDEX index = (ISet::INDEX)state.range(2);
+    std::vector<double> data = bench::uniform(size * dim);
+    std::mt19937_64 random(bench::seed);
+    std::vector<size_t> order;
+    for (size_t left = size; left > size / 2; left--) {
+        order.push_back(std::uniform_int_distribution<size_t>(0, left - 1)(random));
+    }
+    for (auto _ : state) {
+        state.PauseTiming();
+        ISet* set = bench::makeSet(data, dim, IVector::NORM::SECOND, tol, index);
+        set->setRemoveMode(mode);
+        state.ResumeTiming();
+        for (size_t at : order) {
+            set->remove(at);
+        }
+        state.PauseTiming();
+        delete set;
+        state.ResumeTiming();
+    }
+    static const char* modeNames[] = { "SHIFT", "SWAP_LAST", "TOMBSTONE" };
+    state.SetItemsProcessed((int64_t)(state.iterations() * order.size()));
+    state.SetLabel(std::string(modeNames[(int)mode]) + "/" + bench::indexName(index));
+}
+/*
+* SHIFT renumbers the k-d tree on every removal, 100000 vectors take minutes
+*/
+static void sizesModesIndices(benchmark::internal::Benchmark* bm) {
+    bm->ArgNames({ "size", "mode", "index" });
+    for (int64_t size : { 1000, 10000, 100000 }) {
+        for (ISet::REMOVE_MODE mode : { ISet::REMOVE_MODE::SHIFT, ISet::REMOVE_MODE::SWAP_LAST, ISet::REMOVE_MODE::TOMBSTONE }) {
+            for (ISet::INDEX index : { ISet::INDEX::LINEAR, ISet::INDEX::KD_TREE }) {
+                if (size <= 10000 || mode != ISet::REMOVE_MODE::SHIFT || index != ISet::INDEX::KD_TREE) {
+                    bm->Args({ size, (int64_t)mode, (int64_t)index });
+                }
+            }
+        }
+    }
+}
+BENCHMARK(BM_SetRemove)->Apply(sizesModesIndices)->Unit(benchmark::kMillisecond);
+
+static void BM_SetRemoveByPattern(benchmark::State& state) {
+    size_t size = (size_t)state.range(0);
+    IVector::NORM n = (IVector::NORM)state.range(1);
+    std::vector<double> data = bench::uniform(size * dim);
+    std::vector<IVector*> vecs = bench::vectors(data, dim);
+    for (auto _ : state) {
+        state.PauseTiming();
+        ISet* set = bench::makeSet(data, dim, n, tol);
+        state.ResumeTiming();
+        for (size_t i = 0; i < vecs.size(); i += 2) {
+            set->remove(vecs[i], n, tol);
+        }
+        state.PauseTiming();
+        delete set;
+        state.ResumeTiming();
+    }
+    state.SetItemsProcessed((int64_t)(state.iterations() * ((size + 1) / 2)));
+    state.SetLabel(bench::normName(n));
+    bench::release(vecs);
+}
+BENCHMARK(BM_SetRemoveByPattern)->ArgsProduct({ { 1000, 10000 }, norms })->ArgNames({ "size", "norm" })->Unit(benchmark::kMillisecond);
+
+/*
+* Linear scans over clustered and uniform data of dimension 16, for patterns drawn the same way, with tol = 0.25
+* In builds with COLLECT_STATS the counter tells which part of the rows their cached norm alone rejected
+*/
+static void BM_SetPruning(benchmark::State& state) {
+    constexpr size_t wide = 16;
+    size_t size = (size_t)state.range(0);
+    bool clustered = state.range(1) != 0;
+    std::vector<double> data = clustered ? bench::clustered(size, wide, 32, 0.01) : bench::uniform(size * wide);
+    ISet* set = bench::makeSet(data, wide, IVector::NORM::SECOND, tol, ISet::INDEX::LINEAR);
+    std::vector<IVector*> pats = bench::vectors(clustered ? bench::clustered(256, wide, 32, 0.01, 2) : bench::uniform(256 * wide, 2), wide);
+    set->resetStats();
+    size_t next = 0;
+    for (auto _ : state) {
+        IVector const* found = nullptr;
+        if (set->findFirst(pats[next++ % pats.size()], IVector::NORM::SECOND, 0.25, found) == RC::SUCCESS) {
+            delete found;
+        }
+    }
+    ISet::Stats stats;
+    if (set->getStats(stats) == RC::SUCCESS) {
+        state.counters["pruned"] = stats.candidates ? (double)stats.pruned / stats.candidates : 0;
+    }
+    state.SetItemsProcessed((int64_t)(state.iterations() * set->getSize()));
+    state.SetLabel(clustered ? "clustered" : "uniform");
+    bench::release(pats);
+    delete set;
+}
+BENCHMARK(BM_SetPruning)->ArgsProduct({ { 1000, 100000 }, { 0, 1 } })->ArgNames({ "size", "clustered" });
+
+/*
+* findAll() over FLOAT64 and FLOAT32 storage of 16-dimensional vectors
+*/
+static void BM_SetFindAllPrecision(benchmark::State& state) {
+    constexpr size_t wide = 16;
+    size_t size = (size_t)state.range(0);
+    ISet::PRECISION precision = (ISet::PRECISION)state.range(1);
+    std::vector<double> data = bench::uniform(size * wide);
+    ISet* set = bench::makeSet(data, wide, IVector::NORM::SECOND, tol, ISet::INDEX::LINEAR, precision);
+    std::vector<IVector*> pats = bench::vectors(bench::uniform(64 * wide, 3), wide);
+    std::vector<size_t> found;
+    size_t next = 0;
+    for (auto _ : state) {
+        set->findAll(pats[next++ % pats.size()], IVector::NORM::SECOND, 2.0, found);
+        benchmark::DoNotOptimize(found.data());
+    }
+    state.SetItemsProcessed((int64_t)(state.iterations() * size));
+    state.SetLabel(precision == ISet::PRECISION::FLOAT32 ? "FLOAT32" : "FLOAT64");
+    bench::release(pats);
+    delete set;
+}
+BENCHMARK(BM_SetFindAllPrecision)
+    ->ArgsProduct({ { 10000, 100000 }, { (int64_t)ISet::PRECISION::FLOAT64, (int64_t)ISet::PRECISION::FLOAT32 } })
+    ->ArgNames({ "size", "precision" });
+
+/*
+* Same query on 1, 2 and 4 threads, meaningful only on a machine with that many cores
+*/
+static void BM_SetFindAllThreads(benchmark::State& state) {
+    constexpr size_t wide = 16;
+    size_t threads = (size_t)state.range(0);
+    std::vector<double> data = bench::uniform(100000 * wide);
+    ISet* set = bench::makeSet(data, wide, IVector::NORM::SECOND, tol, ISet::INDEX::LINEAR);
+    std::vector<IVector*> pats = bench::vectors(bench::uniform(64 * wide, 3), wide);
+    ISet::setThreadCount(threads);
+    std::vector<size_t> found;
+    size_t next = 0;
+    for (auto _ : state) {
+        set->findAll(pats[next++ % pats.size()], IVector::NORM::SECOND, 2.0, found);
+        benchmark::DoNotOptimize(found.data());
+    }
+    ISet::setThreadCount(1);
+    bench::release(pats);
+    delete set;
+}
+BENCHMARK(BM_SetFindAllThreads)->Arg(1)->Arg(2)->Arg(4)->ArgName("threads")->UseRealTime();
+
+static void BM_SetFindKNearest(benchmark::State& state) {
+    size_t size = (size_t)state.range(0);
+    size_t k = (size_t)state.range(1);
+    std::vector<double> data = bench::uniform(size * dim);
+    ISet* set = bench::makeSet(data, dim, IVector::NORM::SECOND, tol);
+    std::vector<IVector*> pats = patterns(data, 1024);
+    std::vector<size_t> found;
+    std::vector<double> dists;
+    size_t next = 0;
+    for (auto _ : state) {
+        set->findKNearest(pats[next++ % pats.size()], IVector::NORM::SECOND, k, found, dists);
+        benchmark::DoNotOptimize(found.data());
+    }
+    bench::release(pats);
+    delete set;
+}
+BENCHMARK(BM_SetFindKNearest)->ArgsProduct({ { 1000, 100000 }, { 1, 16 } })->ArgNames({ "size", "k" });
+
+static void BM_SetPairwiseDistances(benchmark::State& state) {
+    constexpr size_t wide = 16;
+    size_t size = (size_t)state.range(0);
+    IVector::NORM n = (IVector::NORM)state.range(1);
+    ISet* set = bench::makeSet(bench::uniform(size * wide), wide, n, tol, ISet::INDEX::LINEAR);
+    std::vector<double> out;
+    for (auto _ : state) {
+        set->pairwiseDistances(set, n, out);
+        benchmark::DoNotOptimize(out.data());
+    }
+    state.SetItemsProcessed((int64_t)(state.iterations() * size * size));
+    state.SetLabel(bench::normName(n));
+    delete set;
+}
+BENCHMARK(BM_SetPairwiseDistances)->ArgsProduct({ { 256, 1024 }, norms })->ArgNames({ "size", "norm" })->Unit(benchmark::kMicrosecond);
+
+static void BM_SetGram(benchmark::State& state) {
+    constexpr size_t wide = 16;
+    size_t size = (size_t)state.range(0);
+    ISet* set = bench::makeSet(bench::uniform(size * wide), wide, IVector::NORM::SECOND, tol, ISet::INDEX::LINEAR);
+    std::vector<double> out;
+    for (auto _ : state) {
+        set->gram(out);
+        benchmark::DoNotOptimize(out.data());
+    }
+    state.SetItemsProcessed((int64_t)(state.iterations() * size * size));
+    delete set;
+}
+BENCHMARK(BM_SetGram)->Arg(256)->Arg(1024)->ArgName("size")->Unit(benchmark::kMicrosecond);
+
+/*
+* Intersection or union the naive way: every lookup scans all of the other set and the result is linear too,
+* O(n * m) as a baseline for ISet::makeIntersection() and ISet::makeUnion()
+*/
+static ISet* naiveAlgebra(ISet const* op1, ISet const* op2, bool intersection) {
+    ISet* res = ISet::createSet(nullptr);
+    res->setIndex(ISet::INDEX::LINEAR);
+    for (ISet const* src : { op1, op2 }) {
+        for (size_t i = 0; i < src->getSize(); i++) {
+            IVector const* vec = nullptr;
+            src->get(i, vec);
+            IVector const* found = nullptr;
+            if (!intersection || op2->findFirst(vec, IVector::NORM::SECOND, tol, found) == RC::SUCCESS) {
+                res->insert(vec, IVector::NORM::SECOND, tol);
+            }
+            delete found;
+            delete vec;
+        }
+        if (intersection) {
+            break;
+        }
+    }
+    return res;
+}
+
+/*
+* Two sets of `size` vectors sharing half of them, combined by the library or by naiveAlgebra() over linear sets,
+* which is measured up to 10000
+*/
+static void BM_SetAlgebra(benchmark::State& state) {
+    size_t size = (size_t)state.range(0);
+    bool intersection = state.range(1) != 0;
+    bool naive = state.range(2) != 0;
+    ISet::INDEX index = naive ? ISet::INDEX::LINEAR : ISet::INDEX::KD_TREE;
+    std::vector<double> data = bench::uniform(size * dim * 3 / 2);
+    std::vector<double> first(data.begin(), data.begin() + size * dim);
+    std::vector<double> second(data.begin() + size * dim / 2, data.end());
+    ISet* op1 = bench::makeSet(first, dim, IVector::NORM::SECOND, tol, index);
+    ISet* op2 = bench::makeSet(second, dim, IVector::NORM::SECOND, tol, index);
+    for (auto _ : state) {
+        ISet* res = naive ? naiveAlgebra(op1, op2, intersection) : intersection ?
+            ISet::makeIntersection(op1, op2, IVector::NORM::SECOND, tol) : ISet::makeUnion(op1, op2, IVector::NORM::SECOND, tol);
+        benchmark::DoNotOptimize(res);
+        delete res;
+    }
+    state.SetLabel(std::string(intersection ? "intersection" : "union") + (naive ? "/naive" : ""));
+    delete op1;
+    delete op2;
+}
+static void sizesAlgebra(benchmark::internal::Benchmark* bm) {
+    bm->ArgNames({ "size", "intersection", "naive" });
+    for (int64_t size : { 1000, 10000, 100000 }) {
+        for (int64_t intersection : { 0, 1 }) {
+            for (int64_t naive : { 0, 1 }) {
+                if (size <= 10000 || naive == 0) {
+                    bm->Args({ size, intersection, naive });
+                }
+            }
+        }
+    }
+}
+BENCHMARK(BM_SetAlgebra)->Apply(sizesAlgebra)->Unit(benchmark::kMillisecond);
+
+/*
+* Readers of a concurrent set, all threads share one set of 10000 vectors
+* With `writer` set, one more thread keeps inserting a vector and removing it again while they read,
+* the counter is its rate of changes
+*/
+static void BM_ConcurrentSetFindFirst(benchmark::State& state) {
+    static std::once_flag built;
+    static ISet* set = nullptr;
+    static std::vector<IVector*> pats;
+    static std::vector<IVector*> fresh;
+    static std::thread writer;
+    static std::atomic<bool> stop(false);
+    static std::atomic<size_t> writes(0);
+    std::call_once(built, [] {
+        std::vector<double> data = bench::uniform(10000 * dim);
+        set = ISet::createConcurrentSet(nullptr);
+        for (size_t i = 0; i < data.size(); i += dim) {
+            IVector const* vec = IVector::createVector(dim, data.data() + i);
+            set->insert(vec, IVector::NORM::SECOND, tol);
+            delete vec;
+        }
+        pats = patterns(data, 1024);
+        fresh = bench::vectors(bench::uniform(1024 * dim, 5), dim);
+    });
+    bool writing = state.range(0) != 0 && state.thread_index() == 0;
+    if (writing) {
+        stop = false;
+        writes = 0;
+        writer = std::thread([] {
+            for (size_t i = 0; !stop; i++) {
+                IVector const* vec = fresh[i % fresh.size()];
+                size_t size = set->getSize();
+                set->insert(vec, IVector::NORM::SECOND, tol);
+                if (set->getSize() > size) {
+                    set->remove(size);
+                }
+                writes += 2;
+            }
+        });
+    }
+    size_t next = (size_t)state.thread_index() * 131;
+    for (auto _ : state) {
+        IVector const* found = nullptr;
+        if (set->findFirst(pats[next++ % pats.size()], IVector::NORM::SECOND, tol, found) == RC::SUCCESS) {
+            delete found;
+        }
+    }
+    if (writing) {
+        stop = true;
+        writer.join();
+        state.counters["writes"] = benchmark::Counter((double)writes, benchmark::Counter::kIsRate);
+    }
+}
+BENCHMARK(BM_ConcurrentSetFindFirst)->Arg(0)->Arg(1)->ArgName("writer")->Threads(1)->Threads(4)->Threads(16)->UseRealTime();
+
+/*
+* FixedSet<3> against a LINEAR ISet of the same vectors
+*/
+static void BM_FixedSetFindFirst(benchmark::State& state) {
+    size_t size = (size_t)state.range(0);
+    std::vector<double> data = bench::uniform(size * dim);
+    FixedSet<dim> set;
+    for (size_t i = 0; i < data.size(); i += dim) {
+        set.insert(FixedVector<dim>(data.data() + i), IVector::NORM::SECOND, tol);
+    }
+    std::vector<IVector*> vecs = patterns(data, 1024);
+    std::vector<FixedVector<dim>> pats;
+    for (IVector const* vec : vecs) {
+        pats.emplace_back(vec->getData());
+    }
+    bench::release(vecs);
+    size_t next = 0;
+    for (auto _ : state) {
+        size_t index = 0;
+        benchmark::DoNotOptimize(set.findFirst(pats[next++ % pats.size()], IVector::NORM::SECOND, tol, index));
+    }
+}
+BENCHMARK(BM_FixedSetFindFirst)->Arg(100)->Arg(1000)->ArgName("size");
+
+static void BM_SetFindFirstLinear(benchmark::State& state) {
+    size_t size = (size_t)state.range(0);
+    std::vector<double> data = bench::uniform(size * dim);
+    ISet* set = bench::makeSet(data, dim, IVector::NORM::SECOND, tol, ISet::INDEX::LINEAR);
+    std::vector<IVector*> pats = patterns(data, 1024);
+    size_t next = 0;
+    for (auto _ : state) {
+        IVectorView view;
+        benchmark::DoNotOptimize(set->findFirstView(pats[next++ % pats.size()], IVector::NORM::SECOND, tol, view));
+    }
+    bench::release(pats);
+    delete set;
+}
+BENCHMARK(BM_SetFindFirstLinear)->Arg(100)->Arg(1000)->ArgName("size");
@@ -0,0 +1,244 @@
+#include <benchmark/benchmark.h>
+#include <cmath>
+#include <vector>
+#include "../include/FixedVector.h"
+#include "../include/IAllocator.h"
+#include "../include/IVector.h"
+#include "../include/IVectorView.h"
+#include "../src/Kernels.h"
+#include "BenchData.h"
+
+/*
+* Vector operations across dimensions, allocators, in-place arithmetic, FixedVector and the SIMD kernels
+*/
+
+static const std::vector<int64_t> dims = { 3, 64, 1024, 16384 };
+static const std::vector<int64_t> norms = { (int64_t)IVector::NORM::CHEBYSHEV, (int64_t)IVector::NORM::FIRST, (int64_t)IVector::NORM::SECOND };
+
+enum class Source {
+    HEAP,
+    POOL,
+    ARENA
+};
+
+static void BM_CreateVector(benchmark::State& state) {
+    size_t dim = (size_t)state.range(0);
+    Source source = (Source)state.range(1);
+    std::vector<double> data = bench::uniform(dim);
+    IAllocator* allocator = source == Source::POOL ? IAllocator::createPool() :
+        source == Source::ARENA ? IAllocator::createArena(1 << 20) : nullptr;
+    size_t made = 0;
+    for (auto _ : state) {
+        IVector* vec = IVector::createVector(dim, data.data(), allocator);
+        benchmark::DoNotOptimize(vec);
+        delete vec;
+        // an arena frees nothing on delete
+        if (source == Source::ARENA && ++made % 64 == 0) {
+            allocator->reset();
+        }
+    }
+    state.SetLabel(source == Source::POOL ? "pool" : source == Source::ARENA ? "arena" : "heap");
+    delete allocator;
+}
+BENCHMARK(BM_CreateVector)->ArgsProduct({ dims, { (int64_t)Source::HEAP, (int64_t)Source::POOL, (int64_t)Source::ARENA } })->ArgNames({ "dim", "source" });
+
+static void BM_Norm(benchmark::State& state) {
+    size_t dim = (size_t)state.range(0);
+    IVector::NORM n = (IVector::NORM)state.range(1);
+    std::vector<double> data = bench::uniform(dim);
+    IVector* vec = IVector::createVector(dim, data.data());
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(vec->norm(n));
+    }
+    state.SetBytesProcessed((int64_t)(state.iterations() * dim * sizeof(double)));
+    state.SetLabel(bench::normName(n));
+    delete vec;
+}
+BENCHMARK(BM_Norm)->ArgsProduct({ dims, norms })->ArgNames({ "dim", "norm" });
+
+static void BM_Dot(benchmark::State& state) {
+    size_t dim = (size_t)state.range(0);
+    std::vector<double> data = bench::uniform(2 * dim);
+    IVector* op1 = IVector::createVector(dim, data.data());
+    IVector* op2 = IVector::createVector(dim, data.data() + dim);
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(IVector::dot(op1, op2));
+    }
+    state.SetBytesProcessed((int64_t)(state.iterations() * 2 * dim * sizeof(double)));
+    delete op1;
+    delete op2;
+}
+BENCHMARK(BM_Dot)->ArgsProduct({ dims })->ArgNames({ "dim" });
+
+/*
+* inc and dec alternate, so coordinates stay bounded however many iterations run
+*/
+static void BM_IncDec(benchmark::State& state) {
+    size_t dim = (size_t)state.range(0);
+    std::vector<double> data = bench::uniform(2 * dim);
+    IVector* vec = IVector::createVector(dim, data.data());
+    IVector* op = IVector::createVector(dim, data.data() + dim);
+    for (auto _ : state) {
+        vec->inc(op);
+        vec->dec(op);
+        benchmark::ClobberMemory();
+    }
+    state.SetItemsProcessed((int64_t)state.iterations() * 2);
+    delete vec;
+    delete op;
+}
+BENCHMARK(BM_IncDec)->ArgsProduct({ dims })->ArgNames({ "dim" });
+
+static void BM_Scale(benchmark::State& state) {
+    size_t dim = (size_t)state.range(0);
+    std::vector<double> data = bench::uniform(dim);
+    IVector* vec = IVector::createVector(dim, data.data());
+    for (auto _ : state) {
+        vec->scale(-1);
+        benchmark::ClobberMemory();
+    }
+    state.SetBytesProcessed((int64_t)(state.iterations() * dim * sizeof(double)));
+    delete vec;
+}
+BENCHMARK(BM_Scale)->ArgsProduct({ dims })->ArgNames({ "dim" });
+
+/*
+* add() allocating its result against add() into an existing vector
+*/
+static void BM_Add(benchmark::State& state) {
+    size_t dim = (size_t)state.range(0);
+    bool inPlace = state.range(1) != 0;
+    std::vector<double> data = bench::uniform(2 * dim);
+    IVector* op1 = IVector::createVector(dim, data.data());
+    IVector* op2 = IVector::createVector(dim, data.data() + dim);
+    IVector* dest = op1->clone();
+    for (auto _ : state) {
+        if (inPlace) {
+            IVector::add(dest, op1, op2);
+            benchmark::ClobberMemory();
+        } else {
+            IVector* res = IVector::add(op1, op2);
+            benchmark::DoNotOptimize(res);
+            delete res;
+        }
+    }
+    state.SetLabel(inPlace ? "in place" : "allocating");
+    delete op1;
+    delete op2;
+    delete dest;
+}
+BENCHMARK(BM_Add)->ArgsProduct({ dims, { 0, 1 } })->ArgNames({ "dim", "in_place" });
+
+static void BM_Axpy(benchmark::State& state) {
+    size_t dim = (size_t)state.range(0);
+    std::vector<double> data = bench::uniform(2 * dim);
+    IVector* x = IVector::createVector(dim, data.data());
+    IVector* y = IVector::createVector(dim, data.data() + dim);
+    for (auto _ : state) {
+        IVector::axpy(0.5, x, y);
+        IVector::axpy(-0.5, x, y);
+        benchmark::ClobberMemory();
+    }
+    state.SetItemsProcessed((int64_t)state.iterations() * 2);
+    delete x;
+    delete y;
+}
+BENCHMARK(BM_Axpy)->ArgsProduct({ dims })->ArgNames({ "dim" });
+
+/*
+* Full distance against equals() of two distant vectors, which gives up after the first block of coordinates
+*/
+static void BM_Distance(benchmark::State& state) {
+    size_t dim = (size_t)state.range(0);
+    IVector::NORM n = (IVector::NORM)state.range(1);
+    std::vector<double> data = bench::uniform(2 * dim);
+    IVectorView op1(dim, data.data());
+    IVectorView op2(dim, data.data() + dim);
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(IVector::distance(op1, op2, n));
+    }
+    state.SetLabel(bench::normName(n));
+    state.SetBytesProcessed((int64_t)(state.iterations() * 2 * dim * sizeof(double)));
+}
+BENCHMARK(BM_Distance)->ArgsProduct({ { 128, 512, 2048, 8192 }, norms })->ArgNames({ "dim", "norm" });
+
+static void BM_EqualsFar(benchmark::State& state) {
+    size_t dim = (size_t)state.range(0);
+    IVector::NORM n = (IVector::NORM)state.range(1);
+    std::vector<double> data = bench::uniform(2 * dim);
+    IVectorView op1(dim, data.data());
+    IVectorView op2(dim, data.data() + dim);
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(IVector::equals(op1, op2, n, 0.1));
+    }
+    state.SetLabel(bench::normName(n));
+}
+BENCHMARK(BM_EqualsFar)->ArgsProduct({ { 128, 512, 2048, 8192 }, norms })->ArgNames({ "dim", "norm" });
+
+/*
+* Same distance through each instruction set the machine supports
+*/
+static void BM_KernelDistance(benchmark::State& state) {
+    kernels::ISA isa = (kernels::ISA)state.range(0);
+    size_t dim = (size_t)state.range(1);
+    kernels::ISA previous = kernels::getIsa();
+    if (kernels::setIsa(isa) != RC::SUCCESS) {
+        state.SkipWithError("instruction set is not supported on this machine");
+        return;
+    }
+    std::vector<double> data = bench::uniform(2 * dim);
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(kernels::distance(data.data(), data.data() + dim, dim, IVector::NORM::SECOND));
+    }
+    kernels::setIsa(previous);
+    state.SetLabel(bench::isaName(isa));
+    state.SetBytesProcessed((int64_t)(state.iterations() * 2 * dim * sizeof(double)));
+}
+BENCHMARK(BM_KernelDistance)
+    ->ArgsProduct({ { (int64_t)kernels::ISA::SCALAR, (int64_t)kernels::ISA::SSE2, (int64_t)kernels::ISA::AVX2, (int64_t)kernels::ISA::AVX512 }, { 64, 1024, 16384 } })
+    ->ArgNames({ "isa", "dim" });
+
+/*
+* FixedVector<N> against IVector of the same dimension
+*/
+template <size_t N>
+static void BM_FixedVectorDistance(benchmark::State& state) {
+    std::vector<double> data = bench::uniform(2 * N);
+    FixedVector<N> op1(data.data());
+    FixedVector<N> op2(data.data() + N);
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(op1);
+        benchmark::DoNotOptimize(FixedVector<N>::distance(op1, op2, IVector::NORM::SECOND));
+    }
+}
+BENCHMARK_TEMPLATE(BM_FixedVectorDistance, 3);
+BENCHMARK_TEMPLATE(BM_FixedVectorDistance, 8);
+BENCHMARK_TEMPLATE(BM_FixedVectorDistance, 16);
+
+static void BM_VectorDistance(benchmark::State& state) {
+    size_t dim = (size_t)state.range(0);
+    std::vector<double> data = bench::uniform(2 * dim);
+    IVector* op1 = IVector::createVector(dim, data.data());
+    IVector* op2 = IVector::createVector(dim, data.data() + dim);
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(IVector::distance(op1, op2, IVector::NORM::SECOND));
+    }
+    delete op1;
+    delete op2;
+}
+BENCHMARK(BM_VectorDistance)->Arg(3)->Arg(8)->Arg(16)->ArgName("dim");
+
+template <size_t N>
+static void BM_FixedVectorAdd(benchmark::State& state) {
+    std::vector<double> data = bench::uniform(2 * N);
+    FixedVector<N> op1(data.data());
+    FixedVector<N> op2(data.data() + N);
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(op1);
+        FixedVector<N> res = FixedVector<N>::add(op1, op2);
+        benchmark::DoNotOptimize(res);
+    }
+}
+BENCHMARK_TEMPLATE(BM_FixedVectorAdd, 3);
+BENCHMARK_TEMPLATE(BM_FixedVectorAdd, 8);
+BENCHMARK_TEMPLATE(BM_FixedVectorAdd, 16);
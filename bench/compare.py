@@ -0,0 +1,99 @@
+#!/usr/bin/env python3
+"""
+Compares two JSON results of vector_bench (or any Google Benchmark binary) and flags regressions
+
+Usage: compare.py <baseline.json> <contender.json> [--threshold PERCENT] [--metric cpu_time|real_time]
+
+Benchmarks are matched by name. Runs made with --benchmark_repetitions are compared by their median.
+Exits with 1 if any benchmark got slower by more than the threshold (5% by default), so that it can gate a build.
+"""
+
+import argparse
+import json
+import sys
+
+UNITS = {"ns": 1e-9, "us": 1e-6, "ms": 1e-3, "s": 1.0}
+
+# context fields that make two runs incomparable when they differ
+CONTEXT_KEYS = ["host_name", "num_cpus", "mhz_per_cpu", "library_build_type", "kernels_isa", "fast_math", "optimized"]
+
+
+def load(path):
+    with open(path) as file:
+        return json.load(file)
+
+
+def times(results, metric):
+    """Seconds per iteration by benchmark name, the median aggregate if there is one"""
+    plain = {}
+    medians = {}
+    for bench in results.get("benchmarks", []):
+        if bench.get("error_occurred"):
+            continue
+        value = bench[metric] * UNITS[bench.get("time_unit", "ns")]
+        if bench.get("run_type") == "aggregate":
+            if bench.get("aggregate_name") == "median":
+                medians[bench["run_name"]] = value
+        else:
+            # repetitions share a name, the last one wins unless a median exists
+            plain[bench.get("run_name", bench["name"])] = value
+    plain.update(medians)
+    return plain
+
+
+def format_time(seconds):
+    for unit in ["s", "ms", "us"]:
+        if seconds >= UNITS[unit]:
+            return "%.3f %s" % (seconds / UNITS[unit], unit)
+    return "%.3f ns" % (seconds / UNITS["ns"])
+
+
+def main():
+    parser = argparse.ArgumentParser(description="Flags benchmarks that got slower between two vector_bench runs")
+    parser.add_argument("baseline")
+    parser.add_argument("contender")
+    parser.add_argument("--threshold", type=float, default=5.0, help="allowed slowdown in percent, 5 by default")
+    parser.add_argument("--metric", choices=["cpu_time", "real_time"], default="cpu_time")
+    args = parser.parse_args()
+
+    baseline = load(args.baseline)
+    contender = load(args.contender)
+
+    for key in CONTEXT_KEYS:
+        old = baseline.get("context", {}).get(key)
+        new = contender.get("context", {}).get(key)
+        if old != new:
+            print("warning: %s differs: %s vs %s" % (key, old, new), file=sys.stderr)
+
+    old_times = times(baseline, args.metric)
+    new_times = times(contender, args.metric)
+
+    regressions = []
+    width = max([len(name) for name in old_times] + [len("Benchmark")])
+    print("%-*s %14s %14s %9s" % (width, "Benchmark", "Baseline", "Contender", "Change"))
+    for name, old in old_times.items():
+        if name not in new_times:
+            print("%-*s %14s %14s %9s" % (width, name, format_time(old), "missing", ""))
+            continue
+        new = new_times[name]
+        change = (new - old) / old * 100 if old > 0 else 0.0
+        mark = ""
+        if change > args.threshold:
+            mark = "  REGRESSION"
+            regressions.append(name)
+        elif change < -args.threshold:
+            mark = "  improved"
+        print("%-*s %14s %14s %+8.1f%%%s" % (width, name, format_time(old), format_time(new), change, mark))
+    for name in new_times:
+        if name not in old_times:
+            print("%-*s %14s %14s %9s" % (width, name, "new", format_time(new_times[name]), ""))
+
+    if regressions:
+        print("\n%d of %d benchmarks are more than %.1f%% slower" % (len(regressions), len(old_times), args.threshold))
+        return 1
+    print("\nNo benchmark is more than %.1f%% slower" % args.threshold)
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
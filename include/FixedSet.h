@@ -0,0 +1,136 @@
+#pragma once
+#include <vector>
+#include "FixedVector.h"
+#include "ISet.h"
+
+/*
+* Set of FixedVector<N> stored contiguously by value, with the same tolerance semantics as ISet
+* Lookups are linear scans, meant for small sets where an index doesn't pay off
+*/
+template <size_t N>
+class FixedSet {
+public:
+    using Vector = FixedVector<N>;
+
+    size_t getDim() const {
+        return N;
+    }
+
+    size_t getSize() const {
+        return _vectors.size();
+    }
+
+    RC get(size_t index, Vector& val) const {
+#ifndef FAST_MATH
+        if (index >= _vectors.size()) {
+            return RC::INDEX_OUT_OF_BOUND;
+        }
+#endif
+        val = _vectors[index];
+        return RC::SUCCESS;
+    }
+
+    Vector const* getData() const {
+        return _vectors.data();
+    }
+
+    RC findFirst(Vector const& pat, IVector::NORM n, double tol, size_t& index) const {
+        for (size_t i = 0; i < _vectors.size(); i++) {
+            if (Vector::distance(_vectors[i], pat, n) < tol) {
+                index = i;
+                return RC::SUCCESS;
+            }
+        }
+        return RC::VECTOR_NOT_FOUND;
+    }
+
+    RC findAll(Vector const& pat, IVector::NORM n, double tol, std::vector<size_t>& indices) const {
+        indices.clear();
+        for (size_t i = 0; i < _vectors.size(); i++) {
+            if (Vector::distance(_vectors[i], pat, n) < tol) {
+                indices.push_back(i);
+            }
+        }
+        return indices.empty() ? RC::VECTOR_NOT_FOUND : RC::SUCCESS;
+    }
+
+    /*
+    * Vectors closer than tol to an already stored one are skipped
+    */
+    RC insert(Vector const& val, IVector::NORM n, double tol) {
+        size_t index = 0;
+        if (findFirst(val, n, tol, index) != RC::SUCCESS) {
+            _vectors.push_back(val);
+        }
+        return RC::SUCCESS;
+    }
+
+    RC remove(size_t index) {
+#ifndef FAST_MATH
+        if (index >= _vectors.size()) {
+            return RC::INDEX_OUT_OF_BOUND;
+        }
+#endif
+        _vectors.erase(_vectors.begin() + index);
+        return RC::SUCCESS;
+    }
+
+    RC remove(Vector const& pat, IVector::NORM n, double tol) {
+        size_t index = 0;
+        RC code = findFirst(pat, n, tol, index);
+        if (code == RC::SUCCESS) {
+            _vectors.erase(_vectors.begin() + index);
+        }
+        return code;
+    }
+
+    void reserve(size_t capacity) {
+        _vectors.reserve(capacity);
+    }
+
+    /*
+    * Adapters to the runtime interface, vectors are copied
+    */
+    ISet* toSet(ILogger* logger, IVector::NORM n, double tol) const {
+        ISet* set = ISet::createSet(logger);
+        if (!set) {
+            return nullptr;
+        }
+        set->reserve(_vectors.size());
+        for (Vector const& vec : _vectors) {
+            IVector const* val = vec.toVector();
+            RC code = val ? set->insert(val, n, tol) : RC::ALLOCATION_ERROR;
+            delete val;
+            if (code != RC::SUCCESS) {
+                delete set;
+                return nullptr;
+            }
+        }
+        return set;
+    }
+
+    static RC fromSet(ISet const* src, FixedSet& dest) {
+#ifndef FAST_MATH
+        if (src->getSize() != 0 && src->getDim() != N) {
+            return RC::MISMATCHING_DIMENSIONS;
+        }
+#endif
+        dest._vectors.clear();
+        dest._vectors.reserve(src->getSize());
+        for (size_t i = 0; i < src->getSize(); i++) {
+            IVector const* val = nullptr;
+            RC code = src->get(i, val);
+            if (code != RC::SUCCESS) {
+                return code;
+            }
+            Vector vec;
+            vec.copyFrom(val);
+            delete val;
+            dest._vectors.push_back(vec);
+        }
+        return RC::SUCCESS;
+    }
+
+private:
+    std::vector<Vector> _vectors;
+};
@@ -0,0 +1,178 @@
+#pragma once
+#include <cmath>
+#include <cstddef>
+#include <type_traits>
+#include <utility>
+#include "IAllocator.h"
+#include "IVector.h"
+#include "IVectorView.h"
+
+/*
+* Vector of compile-time dimension N held by value: no vtable, no runtime dimension and no heap allocation
+* Coordinate loops are unrolled over an index sequence, so small vectors may stay in registers
+* Arithmetic does no overflow checks, validation is left to the conversions from IVector
+*/
+template <size_t N>
+class FixedVector {
+public:
+    static_assert(N > 0, "FixedVector needs at least one coordinate");
+
+    static constexpr size_t dim = N;
+
+    constexpr FixedVector() : _data{} {}
+
+    template <typename... T, typename = std::enable_if_t<sizeof...(T) == N && std::conjunction_v<std::is_arithmetic<T>...>>>
+    constexpr FixedVector(T... cords) : _data{ (double)cords... } {}
+
+    explicit constexpr FixedVector(double const* data) : _data{} {
+        unroll([&](size_t i) { _data[i] = data[i]; });
+    }
+
+    constexpr size_t getDim() const {
+        return N;
+    }
+
+    constexpr double const* getData() const {
+        return _data;
+    }
+
+    constexpr double& operator[](size_t index) {
+        return _data[index];
+    }
+
+    constexpr double operator[](size_t index) const {
+        return _data[index];
+    }
+
+    RC getCord(size_t index, double& val) const {
+#ifndef FAST_MATH
+        if (index >= N) {
+            return RC::INDEX_OUT_OF_BOUND;
+        }
+#endif
+        val = _data[index];
+        return RC::SUCCESS;
+    }
+
+    RC setCord(size_t index, double val) {
+#ifndef FAST_MATH
+        if (index >= N) {
+            return RC::INDEX_OUT_OF_BOUND;
+        }
+        if (std::isnan(val) || std::isinf(val)) {
+            return RC::INVALID_ARGUMENT;
+        }
+#endif
+        _data[index] = val;
+        return RC::SUCCESS;
+    }
+
+    constexpr void inc(FixedVector const& op) {
+        unroll([&](size_t i) { _data[i] += op._data[i]; });
+    }
+
+    constexpr void dec(FixedVector const& op) {
+        unroll([&](size_t i) { _data[i] -= op._data[i]; });
+    }
+
+    constexpr void scale(double multiplier) {
+        unroll([&](size_t i) { _data[i] *= multiplier; });
+    }
+
+    static constexpr FixedVector add(FixedVector const& op1, FixedVector const& op2) {
+        FixedVector res = op1;
+        res.inc(op2);
+        return res;
+    }
+
+    static constexpr FixedVector sub(FixedVector const& op1, FixedVector const& op2) {
+        FixedVector res = op1;
+        res.dec(op2);
+        return res;
+    }
+
+    static constexpr double dot(FixedVector const& op1, FixedVector const& op2) {
+        return sum([&](size_t i) { return op1._data[i] * op2._data[i]; });
+    }
+
+    double norm(IVector::NORM n) const {
+        return reduce(n, [&](size_t i) { return _data[i]; });
+    }
+
+    /*
+    * Norm of op1 - op2, the difference is never stored
+    */
+    static double distance(FixedVector const& op1, FixedVector const& op2, IVector::NORM n) {
+        return reduce(n, [&](size_t i) { return op1._data[i] - op2._data[i]; });
+    }
+
+    static bool equals(FixedVector const& op1, FixedVector const& op2, IVector::NORM n, double tol) {
+        return distance(op1, op2, n) < tol;
+    }
+
+    /*
+    * Adapters to the runtime interface, views plug into IVector::dot(), equals() and distance()
+    */
+    IVectorView view() const {
+        return IVectorView(N, _data);
+    }
+
+    IVector* toVector(IAllocator* allocator = nullptr) const {
+        return IVector::createVector(N, _data, allocator);
+    }
+
+    RC copyFrom(IVectorView const& src) {
+#ifndef FAST_MATH
+        if (src.getDim() != N) {
+            return RC::MISMATCHING_DIMENSIONS;
+        }
+#endif
+        double const* data = src.getData();
+        unroll([&](size_t i) { _data[i] = data[i]; });
+        return RC::SUCCESS;
+    }
+
+private:
+    double _data[N];
+
+    template <typename F, size_t... I>
+    static constexpr void unroll(F&& f, std::index_sequence<I...>) {
+        (f(I), ...);
+    }
+
+    template <typename F>
+    static constexpr void unroll(F&& f) {
+        unroll(f, std::make_index_sequence<N>());
+    }
+
+    template <typename F, size_t... I>
+    static constexpr double sum(F&& f, std::index_sequence<I...>) {
+        return (f(I) + ...);
+    }
+
+    template <typename F>
+    static constexpr double sum(F&& f) {
+        return sum(f, std::make_index_sequence<N>());
+    }
+
+    static constexpr double abs(double x) {
+        return x < 0 ? -x : x;
+    }
+
+    template <typename F>
+    static double reduce(IVector::NORM n, F&& cord) {
+        switch (n) {
+        case IVector::NORM::FIRST:
+            return sum([&](size_t i) { return abs(cord(i)); });
+        case IVector::NORM::SECOND:
+            return std::sqrt(sum([&](size_t i) { return cord(i) * cord(i); }));
+        case IVector::NORM::CHEBYSHEV: {
+            double res = 0;
+            unroll([&](size_t i) { res = std::fmax(res, abs(cord(i))); });
+            return res;
+        }
+        default:
+            return NAN;
+        }
+    }
+};
@@ -0,0 +1,44 @@
+#pragma once
+#include <cstddef>
+#include "RC.h"
+
+/*
+* Source of memory for IVector instances, see IVector::createVector() and IVector::setThreadAllocator()
+*
+* Allocators are not thread-safe: use one per thread and delete its vectors on that thread
+* An allocator must outlive every vector created from it
+*/
+class IAllocator {
+public:
+    /*
+    * Recycles freed blocks in size classes, so same-dimension temporaries reuse each other's memory
+    */
+    static IAllocator* createPool();
+
+    /*
+    * Bump allocator over blocks of `blockSize` bytes, deleting a vector frees nothing until reset()
+    */
+    static IAllocator* createArena(size_t blockSize);
+
+    virtual void* allocate(size_t size) = 0;
+    virtual void deallocate(void* ptr, size_t size) = 0;
+
+    /*
+    * Reclaims everything allocated at once, vectors created before become invalid and must not be deleted
+    */
+    virtual RC reset() = 0;
+
+    /*
+    * Bytes requested from the system and not yet returned
+    */
+    virtual size_t sizeAllocated() const = 0;
+
+    virtual ~IAllocator() = 0;
+
+protected:
+    IAllocator() = default;
+
+private:
+    IAllocator(const IAllocator& other) = delete;
+    IAllocator& operator=(const IAllocator& other) = delete;
+};
@@ -1,16 +1,31 @@
 #pragma once
+#include <atomic>
+#include <cstddef>
 #include "RC.h"
 
 /*
 * Defines for comfortable logging with information about caller
+*
+* LOG_LEVEL is the least severe level compiled in: 0 - SEVER, 1 - WARNING, 2 - INFO (default), -1 disables all of them
+* Compiled-in calls are skipped by one branch if the logger is null or its runtime level filters them out,
+* the Logger argument is evaluated once
 */
-
-/*
-#define SendLog(Logger, Code, Level) Logger->log((Code), (Level), __FILE__, __func__, __LINE__)
-#define SendSever(Logger, Code) Logger->sever((Code), __FILE__, __func__, __LINE__)
-#define SendWarning(Logger, Code) Logger->warning((Code), __FILE__, __func__, __LINE__)
-#define SendInfo(Logger, Code) Logger->info((Code), __FILE__, __func__, __LINE__)
-*/
+#ifndef LOG_LEVEL
+#define LOG_LEVEL 2
+#endif
+
+#define SendLog(Logger, Code, Level) \
+    do { \
+        if ((int)(Level) <= LOG_LEVEL) { \
+            ILogger* sendLogTarget = (Logger); \
+            if (sendLogTarget && sendLogTarget->isEnabled(Level)) { \
+                sendLogTarget->log((Code), (Level), __FILE__, __func__, __LINE__); \
+            } \
+        } \
+    } while (0)
+#define SendSever(Logger, Code) SendLog(Logger, Code, ILogger::Level::SEVER)
+#define SendWarning(Logger, Code) SendLog(Logger, Code, ILogger::Level::WARNING)
+#define SendInfo(Logger, Code) SendLog(Logger, Code, ILogger::Level::INFO)
 
 class ILogger {
 public:
@@ -34,6 +49,38 @@ public:
     */
     static ILogger* createLogger(const char* const& filename, bool overwrite = true);
 
+    /*
+    * What an asynchronous logger does with a record when its queue is full
+    */
+    enum class Overflow {
+        DROP,  // Record is discarded
+        BLOCK, // Caller waits until the writer frees a slot
+        COUNT  // Record is discarded, the writer reports how many were lost
+    };
+
+    /*
+    * Logger that only queues records on the calling thread, a background thread formats and writes them in batches
+    *
+    * @param [in] filename Name of file for log output, nullptr for standard output
+    *
+    * @param [in] capacity Number of queued records, rounded up to a power of two
+    *
+    * srcfile and function strings are kept by pointer until written, as __FILE__ and __func__ are
+    * Queued records are written by flush() and on destruction
+    * log() returns ALLOCATION_ERROR for a record the policy discarded
+    */
+    static ILogger* createAsyncLogger(const char* const& filename, bool overwrite = true, Overflow policy = Overflow::COUNT, size_t capacity = 4096);
+
+    /*
+    * Logger writing fixed-size binary records (call site id, RC, level, timestamp, thread) into a memory-mapped file
+    * The log_decoder tool turns the file back into text or JSON
+    *
+    * @param [in] capacity Number of records the file has room for, later records are dropped and counted
+    *
+    * Returns nullptr if the file can't be created and mapped
+    */
+    static ILogger* createBinaryLogger(const char* const& filename, size_t capacity = 1 << 21);
+
     /*
     * Logging is supposed to be implemented by receiving RC error code and writing corresponding string to output
     *
@@ -101,12 +148,59 @@ public:
         return log(code, Level::INFO);
     };
 
+    /*
+    * Writes a line of free text, e.g. statistics, if `level` is enabled
+    * Loggers that only store RC codes (asynchronous and binary ones) return NOT_SUPPORTED
+    */
+    virtual RC logText(Level, const char* const&) {
+        return RC::NOT_SUPPORTED;
+    };
+
+    /*
+    * Returns once every record logged before the call is written
+    */
+    virtual RC flush() {
+        return RC::SUCCESS;
+    };
+
+    /*
+    * Records less severe than `level` are dropped before any formatting, INFO (everything) by default
+    */
+    void setLevel(Level level) {
+        _level.store((int)level, std::memory_order_relaxed);
+    }
+
+    Level getLevel() const {
+        return (Level)_level.load(std::memory_order_relaxed);
+    }
+
+    bool isEnabled(Level level) const {
+        return (int)level <= _level.load(std::memory_order_relaxed);
+    }
+
+    /*
+    * At most `perSecond` records per (code, call site) are written each second, 0 (default) lifts the limit
+    * The next written record of a call site tells how many of its records were dropped
+    */
+    virtual RC setRateLimit(size_t) {
+        return RC::NOT_SUPPORTED;
+    };
+
+    /*
+    * Consecutive copies of a record are written once, followed by "Last message repeated N times", off by default
+    */
+    virtual RC setCoalescing(bool) {
+        return RC::NOT_SUPPORTED;
+    };
+
     virtual ~ILogger() = 0;
 
 private:
     ILogger(const ILogger&);
     ILogger& operator=(const ILogger&);
 
+    std::atomic<int> _level{ (int)Level::INFO };
+
 protected:
     ILogger() = default;
 };
\ No newline at end of file
@@ -1,13 +1,74 @@
 #pragma once
 #include <cstddef>
+#include <functional>
+#include <vector>
 #include "IVector.h"
+#include "IVectorView.h"
 #include "RC.h"
 
 class ISet {
 public:
+	enum class INDEX {
+		LINEAR,  // No index, every query scans all stored vectors
+		GRID,    // Uniform grid over the leading coordinates, cell edge is taken from the first insert() tolerance
+		KD_TREE, // Dynamic k-d tree, default
+		SORTED,  // Rows sorted by their projection on the principal axis, a query sweeps one window of them, the window grows
+		         // with the set, so it suits 2D and 3D point clouds of up to about 10^4 vectors
+		AMOUNT
+	};
+
+	enum class REMOVE_MODE {
+		SHIFT,     // Following vectors move one index down, O(n), default
+		SWAP_LAST, // Last vector takes the index of the removed one, O(1) plus index update
+		TOMBSTONE, // Vector is only marked removed, indices behave as for SHIFT, storage is compacted once half of it is removed
+		AMOUNT
+	};
+
+	enum class PRECISION {
+		FLOAT64, // Default
+		FLOAT32, // Half the memory, coordinates are rounded to float on insert, distances are still accumulated in double
+		AMOUNT
+	};
+
+	/*
+	* Process-wide logger of sets without a logger of their own, safe to change while other threads log
+	*/
 	static RC setLogger(ILogger* const logger);
+
+	/*
+	* Logger used instead on the calling thread, nullptr (default) falls back to setLogger()
+	*/
+	static RC setThreadLogger(ILogger* const logger);
+	static ILogger* getThreadLogger();
 	
+	/*
+	* pLogger is attached to the new set only (see attachLogger()), nullptr leaves it to the thread and process-wide loggers
+	*/
 	static ISet* createSet(ILogger* pLogger);
+	static ISet* createSet(ILogger* pLogger, PRECISION precision);
+
+	/*
+	* Set that may be read from any number of threads while other threads modify it
+	* Reads never block, modifications are serialized and cost about twice as much as for createSet()
+	*/
+	static ISet* createConcurrentSet(ILogger* pLogger);
+	static ISet* createConcurrentSet(ILogger* pLogger, PRECISION precision);
+
+	/*
+	* Set over a file written by save(), queryable without loading: stored vectors are mapped copy-on-write,
+	* norm caches are read and a k-d tree index is taken as saved. Modifications stay in memory, the file is never
+	* changed, and storage moves to memory the first time the set grows. nullptr if the file is missing or malformed,
+	* or memory mapping isn't available on the platform
+	*/
+	static ISet* openMapped(const char* const& path, ILogger* pLogger);
+
+	/*
+	* Number of threads used by scans, batched queries and set algebra of all sets
+	* 1 (default) runs everything on the calling thread, 0 uses all hardware threads
+	* Results are the same and in the same order for any thread count. Safe to call while other threads use sets,
+	* loops already running finish on the previous threads
+	*/
+	static RC setThreadCount(size_t threads);
 
 	static ISet* makeIntersection(ISet const * const& op1, ISet const * const& op2, IVector::NORM n, double tol);
 	static ISet* makeUnion(ISet const * const& op1, ISet const * const& op2, IVector::NORM n, double tol);
@@ -19,15 +80,148 @@ public:
 
 	virtual size_t getDim() const = 0;
 	virtual size_t getSize() const = 0;
+	virtual PRECISION getPrecision() const = 0;
 
 	virtual RC get(size_t index, IVector const*& val) const = 0;
 	virtual RC findFirst(IVector const * const& pat, IVector::NORM n, double tol, IVector const *& val) const = 0;
 
+	/*
+	* Same as get() and findFirst(), but the vector is read in place instead of being copied
+	* Views are invalidated by any non-const call on the set and by its destruction
+	* Sets made by createConcurrentSet() return NOT_SUPPORTED, as writers may change storage at any time,
+	* and so do FLOAT32 sets, which have no doubles to point to
+	*/
+	virtual RC getView(size_t index, IVectorView& view) const = 0;
+	virtual RC findFirstView(IVector const * const& pat, IVector::NORM n, double tol, IVectorView& view) const = 0;
+
+	/*
+	* Indices of all vectors closer than tol to pat, in ascending order
+	*/
+	virtual RC findAll(IVector const * const& pat, IVector::NORM n, double tol, std::vector<size_t>& indices) const = 0;
+
+	/*
+	* Indices of min(k, getSize()) vectors nearest to pat and distances to them, nearest first
+	* Equally distant vectors are ordered by index
+	*/
+	virtual RC findKNearest(IVector const * const& pat, IVector::NORM n, size_t k, std::vector<size_t>& indices, std::vector<double>& dists) const = 0;
+
+	/*
+	* Row-major getSize() x other->getSize() matrix of distances between members of this set and of `other`
+	* SECOND norm uses ||a||^2 + ||b||^2 - 2(a,b), pairs too close for that to be accurate are measured directly
+	*/
+	virtual RC pairwiseDistances(ISet const* other, IVector::NORM n, std::vector<double>& out) const = 0;
+
+	/*
+	* Row-major getSize() x getSize() matrix of dot products between members
+	*/
+	virtual RC gram(std::vector<double>& out) const = 0;
+
 	virtual RC insert(IVector const *& val, IVector::NORM n, double tol) = 0;
 
+	/*
+	* Same as inserting `count` row-major vectors of `dim` coordinates one by one, in order: a vector is dropped
+	* if it's closer than tol to a member or to an earlier vector of the batch. The batch is indexed at once and
+	* looked up in parallel (see setThreadCount()), only vectors with a close earlier one are resolved in order.
+	* Sets without an index get a temporary k-d tree, so a batch costs O(n log n) instead of O(n^2). On a single
+	* thread sets with an index insert vectors one by one, which is cheaper there
+	*/
+	virtual RC insertBatch(double const* rows, size_t dim, size_t count, IVector::NORM n, double tol) = 0;
+
+	/*
+	* Streamed insertBatch(): `read` fills `rows` with at most `capacity` vectors and returns how many it wrote,
+	* 0 ends the stream. Vectors inserted before an error are kept
+	*/
+	using RowReader = std::function<size_t(double* rows, size_t capacity)>;
+	virtual RC insertStream(const RowReader& read, size_t dim, IVector::NORM n, double tol) = 0;
+
+	/*
+	* insertStream() from a file of raw row-major doubles in host byte order
+	*/
+	virtual RC insertFile(const char* const& path, size_t dim, IVector::NORM n, double tol) = 0;
+
 	virtual RC remove(size_t index) = 0;
 	virtual RC remove(IVector const * const& pat, IVector::NORM n, double tol) = 0;
 
+	/*
+	* Removes every vector the predicate holds for in one pass, remaining vectors keep their order
+	* Predicate receives getDim() coordinates and must not modify the set
+	*/
+	virtual RC removeIf(const std::function<bool(double const* vec)>& predicate) = 0;
+
+	/*
+	* Strategy of remove(), switching away from TOMBSTONE compacts the set
+	*/
+	virtual RC setRemoveMode(REMOVE_MODE mode) = 0;
+	virtual REMOVE_MODE getRemoveMode() const = 0;
+
+	/*
+	* Drops vectors removed in TOMBSTONE mode from storage and index
+	*/
+	virtual RC compact() = 0;
+
+	/*
+	* Replaces spatial index used by findFirst(), insert() and remove() by pattern, the index is rebuilt from stored vectors
+	*/
+	virtual RC setIndex(INDEX type) = 0;
+	virtual INDEX getIndex() const = 0;
+
+	/*
+	* Makes room for at least `capacity` vectors, so that bulk loads don't reallocate
+	*/
+	virtual RC reserve(size_t capacity) = 0;
+
+	/*
+	* Releases storage not used by current vectors
+	*/
+	virtual RC shrinkToFit() = 0;
+
+	/*
+	* Storage is enlarged by `factor` (2 by default) each time it runs out, factor must be greater than 1
+	*/
+	virtual RC setGrowthFactor(double factor) = 0;
+
+	/*
+	* Bytes held by the set: instance, vector storage and index
+	*/
+	virtual size_t sizeAllocated() const = 0;
+
+	/*
+	* Work done by this set since creation or resetStats(), counted only in builds with COLLECT_STATS defined,
+	* getStats() returns NOT_SUPPORTED otherwise. Threads count separately, reading sums them up
+	* Norms of a kind are cached, and can prune candidates, from the first insert() using it on
+	*/
+	struct Stats {
+		size_t distances;     // Distances from a pattern to a member computed, and products of members by gram()
+		size_t candidates;    // Members findFirst(), insert() and remove() by pattern considered
+		size_t pruned;        // Candidates rejected by their cached norm alone
+		size_t reallocations; // Storage reallocations
+		size_t bytesMoved;    // Bytes of members moved by removals
+	};
+	virtual RC getStats(Stats& stats) const = 0;
+	virtual RC resetStats() = 0;
+
+	/*
+	* Stats are written to getLogger() as INFO text at most once per `milliseconds`, checked when the set is
+	* queried or modified, 0 (default) stops it
+	*/
+	virtual RC setStatsDump(size_t milliseconds) = 0;
+
+	/*
+	* Writes vectors, cached norms and the index to `path` in a versioned little-endian format for openMapped()
+	* Vectors removed in TOMBSTONE mode are left out, the index is then rebuilt on open
+	*/
+	virtual RC save(const char* const& path) const = 0;
+
+	/*
+	* Logger receiving this set's warnings, nullptr detaches it. Results of set algebra take the logger of op1
+	*/
+	virtual RC attachLogger(ILogger* logger) = 0;
+
+	/*
+	* Logger the set currently reports to: its own, the calling thread's or the process-wide one
+	*/
+	virtual ILogger* getLogger() const = 0;
+
 	virtual ~ISet() = 0;
 
 private:	
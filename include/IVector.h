@@ -4,6 +4,9 @@
 #include <functional>
 #include "RC.h"
 #include "ILogger.h"
+#include "IAllocator.h"
+
+class IVectorView;
 
 class IVector {
 public:
@@ -15,14 +18,52 @@ public:
     };
 
     static IVector* createVector(size_t dim, double const* const& ptr_data);
+
+    /*
+    * Vector memory comes from `allocator` (the heap if nullptr) and goes back to it on delete
+    */
+    static IVector* createVector(size_t dim, double const* const& ptr_data, IAllocator* allocator);
+
+    /*
+    * Allocator used on the calling thread by createVector() without one, add() and sub(), nullptr (default) is the heap
+    * clone() takes memory from the allocator of the cloned vector
+    */
+    static RC setThreadAllocator(IAllocator* allocator);
+    static IAllocator* getThreadAllocator();
     static RC copyInstance(IVector* const dest, IVector const* const& src);
     static RC moveInstance(IVector* const dest, IVector*& src);
 
     virtual IVector* clone() const = 0;
     virtual double const* getData() const = 0;
 
+    /*
+    * Process-wide logger of vectors and of the static operations, safe to change while other threads log
+    */
     static RC setLogger(ILogger* const logger);
 
+    /*
+    * Logger used instead on the calling thread, nullptr (default) falls back to setLogger()
+    */
+    static RC setThreadLogger(ILogger* const logger);
+    static ILogger* getThreadLogger();
+
+    /*
+    * Vectors created in the whole process since start or resetStats(), counted only in builds with COLLECT_STATS
+    * defined, getStats() returns NOT_SUPPORTED otherwise
+    */
+    struct Stats {
+        size_t allocations;    // Vectors created, including clones and results of add() and sub()
+        size_t bytesAllocated; // Memory they took
+    };
+    static RC getStats(Stats& stats);
+    static RC resetStats();
+
+    /*
+    * Stats are written as INFO text at most once per `milliseconds`, checked when a vector is created,
+    * to the logger of the creating thread, 0 (default) stops it
+    */
+    static RC setStatsDump(size_t milliseconds);
+
     virtual RC getCord(size_t index, double& val) const = 0;
     virtual RC setCord(size_t index, double val) = 0;
     virtual RC scale(double multiplier) = 0;
@@ -34,8 +75,36 @@ public:
     static IVector* add(IVector const* const& op1, IVector const* const& op2);
     static IVector* sub(IVector const* const& op1, IVector const* const& op2);
 
+    /*
+    * Write the result into `dest` instead of allocating one, `dest` may be one of the operands
+    */
+    static RC add(IVector* const dest, IVector const* const& op1, IVector const* const& op2);
+    static RC sub(IVector* const dest, IVector const* const& op1, IVector const* const& op2);
+
+    /*
+    * y += alpha * x, y is left unchanged if any coordinate overflows
+    */
+    static RC axpy(double alpha, IVector const* const& x, IVector* const y);
+
+    /*
+    * dest = op1 + t * (op2 - op1), dest is left unchanged if any coordinate overflows
+    */
+    static RC lerp(IVector* const dest, IVector const* const& op1, IVector const* const& op2, double t);
+
+    /*
+    * Norm of op1 - op2 without computing the difference vector, NaN on mismatching dimensions or overflow
+    */
+    static double distance(IVector const* const& op1, IVector const* const& op2, NORM n);
+    static double distance(IVectorView const& op1, IVectorView const& op2, NORM n);
+
     static double dot(IVector const* const& op1, IVector const* const& op2);
     static bool equals(IVector const* const& op1, IVector const* const& op2, NORM n, double tol);
+
+    /*
+    * Same as above for vectors read in place, no copy is made
+    */
+    static double dot(IVectorView const& op1, IVectorView const& op2);
+    static bool equals(IVectorView const& op1, IVectorView const& op2, NORM n, double tol);
     virtual double norm(NORM n) const = 0;
 
     virtual RC applyFunction(const std::function<double(double)>& fun) = 0;
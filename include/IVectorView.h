@@ -0,0 +1,33 @@
+#pragma once
+#include <cstddef>
+#include "IVector.h"
+#include "RC.h"
+
+/*
+* Non-owning read-only view of `dim` coordinates stored elsewhere, e.g. inside an ISet
+* Cheap to copy, valid only as long as the storage it points into is neither changed nor freed
+*/
+class IVectorView {
+public:
+	IVectorView();
+	IVectorView(size_t dim, double const* data);
+	IVectorView(IVector const* vector);
+
+	double const* getData() const;
+	size_t getDim() const;
+	RC getCord(size_t index, double& val) const;
+
+	/*
+	* Same as IVector::norm(), warnings go to the logger of IVector::setThreadLogger() or IVector::setLogger()
+	*/
+	double norm(IVector::NORM n) const;
+
+	/*
+	* Owning copy of the viewed coordinates
+	*/
+	IVector* clone() const;
+
+private:
+	size_t _dim;
+	double const* _data;
+};
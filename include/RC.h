@@ -14,5 +14,6 @@ enum class RC {
     VECTOR_NOT_FOUND, // Couldn't find vector instance in ISet method
     IO_ERROR, // Couldn't write/read to/from file
     MEMORY_INTERSECTION, // Found intersecting memory while copying instance
+    NOT_SUPPORTED, // Operation isn't available for this instance
     AMOUNT
 };
\ No newline at end of file
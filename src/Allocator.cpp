@@ -0,0 +1,175 @@
+#include <algorithm>
+#include <cstdlib>
+#include "Allocator.h"
+
+constexpr size_t defaultArenaBlock = 64 * 1024;
+
+IAllocator* IAllocator::createPool() {
+    return new PoolAllocator();
+}
+
+IAllocator* IAllocator::createArena(size_t blockSize) {
+    return new ArenaAllocator(blockSize == 0 ? defaultArenaBlock : blockSize);
+}
+
+IAllocator::~IAllocator() = default;
+
+/*
+* PoolAllocator
+*/
+
+PoolAllocator::PoolAllocator() {
+    std::fill(std::begin(_free), std::end(_free), nullptr);
+    _slabCur = nullptr;
+    _slabEnd = nullptr;
+    _largeBlocks = nullptr;
+    _large = 0;
+}
+
+inline size_t PoolAllocator::sizeClass(size_t size) {
+    return (size + granularity - 1) / granularity;
+}
+
+void* PoolAllocator::allocate(size_t size) {
+    if (size > maxPooledSize) {
+        LargeBlock* block = (LargeBlock*)malloc(sizeof(LargeBlock) + size);
+        if (!block) {
+            return nullptr;
+        }
+        block->prev = nullptr;
+        block->next = _largeBlocks;
+        if (_largeBlocks) {
+            _largeBlocks->prev = block;
+        }
+        _largeBlocks = block;
+        _large += sizeof(LargeBlock) + size;
+        return block + 1;
+    }
+    size_t cls = sizeClass(size);
+    if (_free[cls]) {
+        FreeBlock* block = _free[cls];
+        _free[cls] = block->next;
+        return block;
+    }
+    size_t blockSize = cls * granularity;
+    if ((size_t)(_slabEnd - _slabCur) < blockSize) {
+        // the rest of the old slab is too small for this class and stays unused
+        void* slab = malloc(slabSize);
+        if (!slab) {
+            return nullptr;
+        }
+        _slabs.push_back(slab);
+        _slabCur = (char*)slab;
+        _slabEnd = _slabCur + slabSize;
+    }
+    void* mem = _slabCur;
+    _slabCur += blockSize;
+    return mem;
+}
+
+void PoolAllocator::deallocate(void* ptr, size_t size) {
+    if (!ptr) {
+        return;
+    }
+    if (size > maxPooledSize) {
+        LargeBlock* block = (LargeBlock*)ptr - 1;
+        if (block->prev) {
+            block->prev->next = block->next;
+        } else {
+            _largeBlocks = block->next;
+        }
+        if (block->next) {
+            block->next->prev = block->prev;
+        }
+        _large -= sizeof(LargeBlock) + size;
+        free(block);
+        return;
+    }
+    FreeBlock* block = (FreeBlock*)ptr;
+    size_t cls = sizeClass(size);
+    block->next = _free[cls];
+    _free[cls] = block;
+}
+
+RC PoolAllocator::reset() {
+    for (void* slab : _slabs) {
+        free(slab);
+    }
+    _slabs.clear();
+    while (_largeBlocks) {
+        LargeBlock* next = _largeBlocks->next;
+        free(_largeBlocks);
+        _largeBlocks = next;
+    }
+    _large = 0;
+    std::fill(std::begin(_free), std::end(_free), nullptr);
+    _slabCur = nullptr;
+    _slabEnd = nullptr;
+    return RC::SUCCESS;
+}
+
+size_t PoolAllocator::sizeAllocated() const {
+    return sizeof(PoolAllocator) + _slabs.size() * slabSize + _large;
+}
+
+PoolAllocator::~PoolAllocator() {
+    reset();
+}
+
+/*
+* ArenaAllocator
+*/
+
+ArenaAllocator::ArenaAllocator(size_t blockSize) {
+    _blockSize = blockSize;
+    _current = 0;
+    _cur = nullptr;
+    _end = nullptr;
+}
+
+void* ArenaAllocator::allocate(size_t size) {
+    size = (size + alignment - 1) / alignment * alignment;
+    while ((size_t)(_end - _cur) < size) {
+        // chunks kept by reset() are reused before new ones are requested
+        if (_cur) {
+            _current++;
+        }
+        if (_current == _chunks.size()) {
+            size_t chunkSize = std::max(_blockSize, size);
+            void* mem = malloc(chunkSize);
+            if (!mem) {
+                return nullptr;
+            }
+            _chunks.push_back({ mem, chunkSize });
+        }
+        _cur = (char*)_chunks[_current].mem;
+        _end = _cur + _chunks[_current].size;
+    }
+    void* mem = _cur;
+    _cur += size;
+    return mem;
+}
+
+void ArenaAllocator::deallocate(void*, size_t) {
+}
+
+RC ArenaAllocator::reset() {
+    _current = 0;
+    _cur = nullptr;
+    _end = nullptr;
+    return RC::SUCCESS;
+}
+
+size_t ArenaAllocator::sizeAllocated() const {
+    size_t size = sizeof(ArenaAllocator);
+    for (const Chunk& chunk : _chunks) {
+        size += chunk.size;
+    }
+    return size;
+}
+
+ArenaAllocator::~ArenaAllocator() {
+    for (const Chunk& chunk : _chunks) {
+        free(chunk.mem);
+    }
+}
@@ -0,0 +1,74 @@
+#pragma once
+#include <cstddef>
+#include <vector>
+#include "../include/IAllocator.h"
+
+/*
+* Size classes are multiples of `granularity`, each class keeps an intrusive free list of its blocks
+* Blocks are carved from slabs, requests above `maxPooledSize` go straight to the heap and are kept in a list,
+* so that reset() frees them too
+*/
+class PoolAllocator : public IAllocator {
+public:
+    PoolAllocator();
+
+    virtual void* allocate(size_t size) override;
+    virtual void deallocate(void* ptr, size_t size) override;
+    virtual RC reset() override;
+    virtual size_t sizeAllocated() const override;
+
+    virtual ~PoolAllocator();
+
+private:
+    static constexpr size_t granularity = 16;
+    static constexpr size_t maxPooledSize = 4096;
+    static constexpr size_t slabSize = 64 * 1024;
+
+    struct FreeBlock {
+        FreeBlock* next;
+    };
+
+    // header in front of a heap block, aligned so that the block after it keeps malloc() alignment
+    struct alignas(16) LargeBlock {
+        LargeBlock* prev;
+        LargeBlock* next;
+    };
+
+    FreeBlock* _free[maxPooledSize / granularity + 1];
+    std::vector<void*> _slabs;
+    char* _slabCur;
+    char* _slabEnd;
+    LargeBlock* _largeBlocks;
+    size_t _large;
+
+    static size_t sizeClass(size_t size);
+};
+
+/*
+* Blocks are handed out consecutively from the current chunk, a new chunk is taken when it runs out
+*/
+class ArenaAllocator : public IAllocator {
+public:
+    ArenaAllocator(size_t blockSize);
+
+    virtual void* allocate(size_t size) override;
+    virtual void deallocate(void* ptr, size_t size) override;
+    virtual RC reset() override;
+    virtual size_t sizeAllocated() const override;
+
+    virtual ~ArenaAllocator();
+
+private:
+    static constexpr size_t alignment = 16;
+
+    struct Chunk {
+        void* mem;
+        size_t size;
+    };
+
+    size_t _blockSize;
+    std::vector<Chunk> _chunks;
+    size_t _current;
+    char* _cur;
+    char* _end;
+};
@@ -0,0 +1,293 @@
+#include <chrono>
+#include <cstdint>
+#include <cstring>
+#include "AsyncLogger.h"
+#include "Logger.h"
+
+#ifdef __unix__
+#include <cerrno>
+#include <sys/uio.h>
+#include <unistd.h>
+#else
+struct iovec {
+    void* iov_base;
+    size_t iov_len;
+};
+#endif
+
+// wakeups are also requested by log(), the timeout only bounds a missed one
+constexpr std::chrono::milliseconds idleWait(10);
+constexpr size_t maxCapacity = SIZE_MAX / 4;
+// pieces of a record with caller information, see Logger::log()
+constexpr size_t piecesPerRecord = 12;
+constexpr size_t noteSize = 160;
+
+static void writeAll(FILE* stream, struct iovec* iov, size_t count) {
+#ifdef __unix__
+    int fd = fileno(stream);
+    while (count > 0) {
+        ssize_t done = writev(fd, iov, (int)count);
+        if (done < 0 && errno == EINTR) {
+            continue;
+        }
+        if (done <= 0) {
+            return;
+        }
+        while (count > 0 && (size_t)done >= iov->iov_len) {
+            done -= iov->iov_len;
+            iov++;
+            count--;
+        }
+        if (count > 0) {
+            iov->iov_base = (char*)iov->iov_base + done;
+            iov->iov_len -= done;
+        }
+    }
+#else
+    for (size_t i = 0; i < count; i++) {
+        fwrite(iov[i].iov_base, 1, iov[i].iov_len, stream);
+    }
+    fflush(stream);
+#endif
+}
+
+ILogger* ILogger::createAsyncLogger(const char* const& filename, bool overwrite, Overflow policy, size_t capacity) {
+    if (capacity == 0 || capacity > maxCapacity) {
+        return nullptr;
+    }
+    return new AsyncLogger(filename, overwrite, policy, capacity);
+}
+
+AsyncLogger::AsyncLogger(const char* const& filename, bool overwrite, Overflow policy, size_t capacity) {
+    _stream = stdout;
+    if (filename) {
+        _stream = fopen(filename, overwrite ? "w" : "a");
+        if (!_stream) {
+            printf("%s: %s %s\n", Logger::getLevel(Level::WARNING), Logger::getMessage(RC::FILE_NOT_FOUND), filename);
+            _stream = stdout;
+        }
+    }
+    _policy = policy;
+
+    size_t size = 2;
+    while (size < capacity) {
+        size *= 2;
+    }
+    std::vector<Slot> slots(size);
+    _slots.swap(slots);
+    for (size_t i = 0; i < size; i++) {
+        _slots[i].sequence = i;
+    }
+    _mask = size - 1;
+    _enqueuePos = 0;
+    _dequeuePos = 0;
+    _written = 0;
+    _dropped = 0;
+    _flushTickets = 0;
+    _flushed = 0;
+    _sleeping = false;
+    _stop = false;
+    _writer = std::thread(&AsyncLogger::run, this);
+}
+
+bool AsyncLogger::tryPush(const Record& record) {
+    size_t pos = _enqueuePos.load(std::memory_order_relaxed);
+    while (true) {
+        Slot& slot = _slots[pos & _mask];
+        size_t sequence = slot.sequence.load(std::memory_order_acquire);
+        intptr_t lag = (intptr_t)(sequence - pos);
+        if (lag == 0) {
+            if (_enqueuePos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+                slot.record = record;
+                slot.sequence.store(pos + 1, std::memory_order_release);
+                return true;
+            }
+        } else if (lag < 0) {
+            // the slot still holds a record from one lap ago
+            return false;
+        } else {
+            pos = _enqueuePos.load(std::memory_order_relaxed);
+        }
+    }
+}
+
+bool AsyncLogger::pop(Record& record) {
+    Slot& slot = _slots[_dequeuePos & _mask];
+    if (slot.sequence.load(std::memory_order_acquire) != _dequeuePos + 1) {
+        return false;
+    }
+    record = slot.record;
+    slot.sequence.store(_dequeuePos + _slots.size(), std::memory_order_release);
+    _dequeuePos++;
+    return true;
+}
+
+RC AsyncLogger::push(const Record& record) {
+    while (!tryPush(record)) {
+        if (_policy != Overflow::BLOCK) {
+            if (_policy == Overflow::COUNT) {
+                _dropped.fetch_add(1, std::memory_order_relaxed);
+            }
+            return RC::ALLOCATION_ERROR;
+        }
+        wake();
+        std::this_thread::yield();
+    }
+    wake();
+    return RC::SUCCESS;
+}
+
+void AsyncLogger::wake() {
+    if (_sleeping.load()) {
+        std::lock_guard<std::mutex> guard(_wakeMutex);
+        _wakeup.notify_one();
+    }
+}
+
+RC AsyncLogger::log(RC code, Level level, const char* const& srcfile, const char* const& function, int line) {
+    if (!isEnabled(level)) {
+        return RC::SUCCESS;
+    }
+    return push({ code, level, srcfile, function, line });
+}
+
+RC AsyncLogger::log(RC code, Level level) {
+    if (!isEnabled(level)) {
+        return RC::SUCCESS;
+    }
+    return push({ code, level, nullptr, nullptr, 0 });
+}
+
+RC AsyncLogger::setRateLimit(size_t perSecond) {
+    _filter.setRateLimit(perSecond);
+    return RC::SUCCESS;
+}
+
+RC AsyncLogger::setCoalescing(bool coalesce) {
+    _filter.setCoalescing(coalesce);
+    return RC::SUCCESS;
+}
+
+RC AsyncLogger::flush() {
+    size_t target = _enqueuePos.load();
+    size_t ticket = _flushTickets.fetch_add(1) + 1;
+    while (_written.load() < target || _flushed.load() < ticket) {
+        {
+            std::lock_guard<std::mutex> guard(_wakeMutex);
+            _wakeup.notify_one();
+        }
+        std::this_thread::yield();
+    }
+    return RC::SUCCESS;
+}
+
+void AsyncLogger::writeBatch(Record const* records, size_t count) {
+    struct iovec pieces[batchSize * piecesPerRecord];
+    char lines[batchSize][16];
+    char notes[batchSize][noteSize];
+    size_t used = 0;
+    auto add = [&](const char* text) {
+        pieces[used].iov_base = (void*)text;
+        pieces[used].iov_len = strlen(text);
+        used++;
+    };
+    for (size_t i = 0; i < count; i++) {
+        const Record& record = records[i];
+        LogFilter::Pending pending;
+        if (!_filter.admit(record.code, record.level, record.srcfile, record.function, record.line, pending)) {
+            continue;
+        }
+        Logger::formatPending(pending, notes[i], noteSize);
+        if (notes[i][0]) {
+            add(notes[i]);
+        }
+        if (!record.srcfile) {
+            add(Logger::getLevel(record.level));
+            add(": ");
+            add(Logger::getMessage(record.code));
+            add("\n");
+            continue;
+        }
+        snprintf(lines[i], sizeof(lines[i]), "%i", record.line);
+        add("#####\n");
+        add(Logger::getLevel(record.level));
+        add(": ");
+        add(Logger::getMessage(record.code));
+        add("\nFile: ");
+        add(record.srcfile);
+        add("\nLine: ");
+        add(lines[i]);
+        add("\nFunction: ");
+        add(record.function ? record.function : "");
+        add("\n#####\n");
+    }
+    if (used == 0) {
+        return;
+    }
+    // pending stdio output of the same stream goes first
+    fflush(_stream);
+    writeAll(_stream, pieces, used);
+}
+
+void AsyncLogger::writeNote(const char* text) {
+    struct iovec piece = { (void*)text, strlen(text) };
+    fflush(_stream);
+    writeAll(_stream, &piece, 1);
+}
+
+void AsyncLogger::run() {
+    Record batch[batchSize];
+    while (true) {
+        size_t count = 0;
+        while (count < batchSize && pop(batch[count])) {
+            count++;
+        }
+        if (count > 0) {
+            writeBatch(batch, count);
+            _written.fetch_add(count);
+        }
+        size_t dropped = _dropped.exchange(0, std::memory_order_relaxed);
+        if (dropped > 0) {
+            char text[64];
+            snprintf(text, sizeof(text), "%s: %zu log records dropped\n", Logger::getLevel(Level::WARNING), dropped);
+            writeNote(text);
+        }
+        if (count == batchSize) {
+            continue;
+        }
+        // the ring is drained up to this point, so repeats reported now precede anything logged after flush()
+        size_t tickets = _flushTickets.load();
+        bool stop = _stop.load();
+        if (tickets != _flushed.load() || stop) {
+            char text[noteSize];
+            Logger::formatRepeated(_filter.takeRepeated(), text, sizeof(text));
+            if (text[0]) {
+                writeNote(text);
+            }
+            _flushed.store(tickets);
+        }
+        if (stop && _written.load() == _enqueuePos.load()) {
+            return;
+        }
+
+        std::unique_lock<std::mutex> guard(_wakeMutex);
+        _sleeping.store(true);
+        Slot& next = _slots[_dequeuePos & _mask];
+        if (next.sequence.load(std::memory_order_acquire) != _dequeuePos + 1 && !_stop.load()) {
+            _wakeup.wait_for(guard, idleWait);
+        }
+        _sleeping.store(false);
+    }
+}
+
+AsyncLogger::~AsyncLogger() {
+    {
+        std::lock_guard<std::mutex> guard(_wakeMutex);
+        _stop = true;
+        _wakeup.notify_one();
+    }
+    _writer.join();
+    if (_stream != stdout) {
+        fclose(_stream);
+    }
+}
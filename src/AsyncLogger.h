@@ -0,0 +1,79 @@
+#pragma once
+#include <atomic>
+#include <condition_variable>
+#include <cstdio>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include "../include/ILogger.h"
+#include "LogFilter.h"
+
+/*
+* Logger that moves formatting and writing off the calling thread
+*
+* log() claims a slot of a bounded lock-free ring (multiple producers, the writer thread is the only consumer)
+* and stores the record as plain values. The writer drains the ring in batches and writes every batch with one
+* writev() of static strings, so nothing is copied or formatted except line numbers.
+* Level filtering happens on the calling thread, rate limiting and coalescing on the writer
+*/
+class AsyncLogger : public ILogger {
+public:
+    AsyncLogger(const char* const& filename, bool overwrite, Overflow policy, size_t capacity);
+
+    virtual RC log(RC code, Level level, const char* const& srcfile, const char* const& function, int line) override;
+    virtual RC log(RC code, Level level) override;
+    virtual RC flush() override;
+    virtual RC setRateLimit(size_t perSecond) override;
+    virtual RC setCoalescing(bool coalesce) override;
+
+    virtual ~AsyncLogger();
+
+private:
+    static constexpr size_t batchSize = 64;
+
+    struct Record {
+        RC code;
+        Level level;
+        const char* srcfile;
+        const char* function;
+        int line;
+    };
+
+    struct Slot {
+        std::atomic<size_t> sequence;
+        Record record;
+    };
+
+    /*
+    * False if the ring is full
+    */
+    bool tryPush(const Record& record);
+    bool pop(Record& record);
+    RC push(const Record& record);
+
+    void wake();
+    void run();
+    void writeBatch(Record const* records, size_t count);
+    void writeNote(const char* text);
+
+    FILE* _stream;
+    Overflow _policy;
+    std::vector<Slot> _slots;
+    size_t _mask;
+
+    alignas(64) std::atomic<size_t> _enqueuePos;
+    alignas(64) size_t _dequeuePos;
+    std::atomic<size_t> _written;
+    std::atomic<size_t> _dropped;
+    LogFilter _filter;
+
+    // flush() takes a ticket, the writer reports coalesced repeats and publishes the last ticket served
+    std::atomic<size_t> _flushTickets;
+    std::atomic<size_t> _flushed;
+
+    std::atomic<bool> _sleeping;
+    std::atomic<bool> _stop;
+    std::mutex _wakeMutex;
+    std::condition_variable _wakeup;
+    std::thread _writer;
+};
@@ -0,0 +1,48 @@
+#pragma once
+#include <cstdint>
+
+/*
+* On-disk layout of logs written by ILogger::createBinaryLogger(), shared with the decoder tool
+*
+* A Header is followed by fixed-size Records, all little-endian. A call site is described once by a SITE record,
+* followed by the file and function names (without terminators) padded to whole records, and is referred to by id
+* afterwards. Records are claimed concurrently, so a crash may leave EMPTY holes, readers skip them
+*/
+namespace binlog {
+
+constexpr char magic[8] = { 'R', 'C', 'B', 'I', 'N', 'L', 'O', 'G' };
+constexpr uint32_t version = 1;
+
+enum class Kind : uint8_t {
+    EMPTY,  // Never written
+    RECORD, // Logged RC code
+    SITE    // Call site definition
+};
+
+struct Header {
+    char magic[8];
+    uint32_t version;
+    uint32_t recordSize;
+    uint64_t capacity;     // Records the file was created for
+    uint64_t count;        // Records written, 0 if the logger wasn't closed
+    uint64_t dropped;      // Records lost because the file was full
+    int64_t startRealtime; // Wall clock of the logger creation, nanoseconds since the Unix epoch
+    uint64_t reserved[2];
+};
+
+struct Record {
+    uint64_t time;           // Nanoseconds since the logger creation, monotonic
+    uint32_t site;           // Call site id, 0 for records logged without caller information
+    uint32_t thread;         // Small id, numbered in order of first use
+    uint16_t code;           // RC
+    uint8_t level;           // ILogger::Level
+    uint8_t kind;            // Kind
+    uint32_t line;           // SITE only
+    uint32_t fileLength;     // SITE only
+    uint32_t functionLength; // SITE only
+};
+
+static_assert(sizeof(Header) == 64, "header layout is part of the format");
+static_assert(sizeof(Record) == 32, "record layout is part of the format");
+
+}
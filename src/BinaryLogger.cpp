@@ -0,0 +1,208 @@
+#include <algorithm>
+#include <cstring>
+#include <functional>
+#include "BinaryLogger.h"
+
+#ifdef __unix__
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
+
+constexpr size_t maxCapacity = (SIZE_MAX - sizeof(binlog::Header)) / sizeof(binlog::Record) / 2;
+// direct-mapped, a collision costs one locked lookup
+constexpr size_t siteCacheSize = 64;
+
+static std::atomic<uint64_t> nextLoggerId(1);
+static std::atomic<uint32_t> nextThreadId(1);
+static thread_local uint32_t threadId = nextThreadId++;
+
+namespace {
+
+struct CachedSite {
+    uint64_t logger;
+    const char* srcfile;
+    const char* function;
+    int line;
+    uint32_t id;
+};
+
+// loggers are told apart by ids that are never reused, so entries of a destroyed logger just miss
+thread_local CachedSite siteCache[siteCacheSize];
+
+}
+
+static bool isLittleEndian() {
+    uint16_t probe = 1;
+    unsigned char first = 0;
+    memcpy(&first, &probe, 1);
+    return first == 1;
+}
+
+ILogger* ILogger::createBinaryLogger(const char* const& filename, size_t capacity) {
+    if (!filename || capacity == 0 || capacity > maxCapacity || !isLittleEndian()) {
+        return nullptr;
+    }
+    return BinaryLogger::create(filename, capacity);
+}
+
+bool BinaryLogger::Site::operator==(const Site& other) const {
+    return srcfile == other.srcfile && function == other.function && line == other.line;
+}
+
+size_t BinaryLogger::SiteHash::operator()(const Site& site) const {
+    size_t hash = std::hash<const void*>()(site.srcfile);
+    hash ^= std::hash<const void*>()(site.function) + (hash << 6) + (hash >> 2);
+    hash ^= (size_t)site.line * 0x9E3779B97F4A7C15ull + (hash << 6) + (hash >> 2);
+    return hash;
+}
+
+BinaryLogger* BinaryLogger::create(const char* filename, size_t capacity) {
+#ifdef __unix__
+    int fd = open(filename, O_RDWR | O_CREAT | O_TRUNC, 0644);
+    if (fd < 0) {
+        return nullptr;
+    }
+    size_t size = sizeof(binlog::Header) + capacity * sizeof(binlog::Record);
+    // the file stays sparse until records are written
+    if (ftruncate(fd, (off_t)size) != 0) {
+        close(fd);
+        return nullptr;
+    }
+    void* map = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    if (map == MAP_FAILED) {
+        close(fd);
+        return nullptr;
+    }
+    return new BinaryLogger(fd, (char*)map, capacity);
+#else
+    return nullptr;
+#endif
+}
+
+BinaryLogger::BinaryLogger(int fd, char* map, size_t capacity) {
+    _fd = fd;
+    _map = map;
+    _capacity = capacity;
+    _id = nextLoggerId++;
+    _start = std::chrono::steady_clock::now();
+    _next = 0;
+    _dropped = 0;
+
+    binlog::Header header = {};
+    memcpy(header.magic, binlog::magic, sizeof(header.magic));
+    header.version = binlog::version;
+    header.recordSize = sizeof(binlog::Record);
+    header.capacity = capacity;
+    header.startRealtime = std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::system_clock::now().time_since_epoch()).count();
+    memcpy(_map, &header, sizeof(header));
+}
+
+binlog::Record* BinaryLogger::claim(size_t count) {
+    size_t first = _next.fetch_add(count, std::memory_order_relaxed);
+    if (first + count > _capacity) {
+        _dropped.fetch_add(1, std::memory_order_relaxed);
+        return nullptr;
+    }
+    return (binlog::Record*)(_map + sizeof(binlog::Header)) + first;
+}
+
+uint32_t BinaryLogger::intern(const Site& site) {
+    std::lock_guard<std::mutex> guard(_sitesMutex);
+    auto it = _sites.find(site);
+    if (it != _sites.end()) {
+        return it->second;
+    }
+    size_t fileLength = strlen(site.srcfile);
+    size_t functionLength = site.function ? strlen(site.function) : 0;
+    size_t textRecords = (fileLength + functionLength + sizeof(binlog::Record) - 1) / sizeof(binlog::Record);
+    binlog::Record* records = claim(1 + textRecords);
+    if (!records) {
+        return 0;
+    }
+    uint32_t id = (uint32_t)_sites.size() + 1;
+    char* text = (char*)(records + 1);
+    memcpy(text, site.srcfile, fileLength);
+    if (functionLength > 0) {
+        memcpy(text + fileLength, site.function, functionLength);
+    }
+    records[0].site = id;
+    records[0].thread = threadId;
+    records[0].line = (uint32_t)site.line;
+    records[0].fileLength = (uint32_t)fileLength;
+    records[0].functionLength = (uint32_t)functionLength;
+    records[0].kind = (uint8_t)binlog::Kind::SITE;
+    _sites.emplace(site, id);
+    return id;
+}
+
+uint32_t BinaryLogger::siteOf(const char* srcfile, const char* function, int line) {
+    if (!srcfile) {
+        return 0;
+    }
+    size_t slot = (std::hash<const void*>()(srcfile) ^ (size_t)line * 0x9E3779B97F4A7C15ull) % siteCacheSize;
+    CachedSite& cached = siteCache[slot];
+    if (cached.logger == _id && cached.srcfile == srcfile && cached.function == function && cached.line == line) {
+        return cached.id;
+    }
+    uint32_t id = intern({ srcfile, function, line });
+    if (id != 0) {
+        cached = { _id, srcfile, function, line, id };
+    }
+    return id;
+}
+
+RC BinaryLogger::append(RC code, Level level, uint32_t site) {
+    binlog::Record* record = claim(1);
+    if (!record) {
+        return RC::ALLOCATION_ERROR;
+    }
+    record->time = (uint64_t)std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - _start).count();
+    record->site = site;
+    record->thread = threadId;
+    record->code = (uint16_t)code;
+    record->level = (uint8_t)level;
+    record->kind = (uint8_t)binlog::Kind::RECORD;
+    return RC::SUCCESS;
+}
+
+RC BinaryLogger::log(RC code, Level level, const char* const& srcfile, const char* const& function, int line) {
+    if (!isEnabled(level)) {
+        return RC::SUCCESS;
+    }
+    return append(code, level, siteOf(srcfile, function, line));
+}
+
+RC BinaryLogger::log(RC code, Level level) {
+    if (!isEnabled(level)) {
+        return RC::SUCCESS;
+    }
+    return append(code, level, 0);
+}
+
+RC BinaryLogger::flush() {
+#ifdef __unix__
+    size_t used = std::min(_next.load(), _capacity);
+    size_t size = sizeof(binlog::Header) + used * sizeof(binlog::Record);
+    return msync(_map, size, MS_SYNC) == 0 ? RC::SUCCESS : RC::IO_ERROR;
+#else
+    return RC::NOT_SUPPORTED;
+#endif
+}
+
+BinaryLogger::~BinaryLogger() {
+#ifdef __unix__
+    size_t used = std::min(_next.load(), _capacity);
+    binlog::Header* header = (binlog::Header*)_map;
+    header->count = used;
+    header->dropped = _dropped.load();
+    size_t size = sizeof(binlog::Header) + used * sizeof(binlog::Record);
+    munmap(_map, sizeof(binlog::Header) + _capacity * sizeof(binlog::Record));
+    if (ftruncate(_fd, (off_t)size) != 0) {
+        // safe to ignore: the file keeps its full size, the header counts only the records written
+        // and readers skip the trailing EMPTY ones
+    }
+    close(_fd);
+#endif
+}
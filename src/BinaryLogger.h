@@ -0,0 +1,70 @@
+#pragma once
+#include <atomic>
+#include <chrono>
+#include <mutex>
+#include <unordered_map>
+#include "../include/ILogger.h"
+#include "BinaryLogFormat.h"
+
+/*
+* Logger writing fixed-size binary records into a memory-mapped file, see BinaryLogFormat.h
+*
+* A record is claimed by one atomic increment and filled in place, nothing is formatted. Call sites are interned
+* once per logger under a lock, afterwards every thread finds their ids in a small thread-local cache
+*/
+class BinaryLogger : public ILogger {
+public:
+    /*
+    * Null if the file can't be created or mapped
+    */
+    static BinaryLogger* create(const char* filename, size_t capacity);
+
+    virtual RC log(RC code, Level level, const char* const& srcfile, const char* const& function, int line) override;
+    virtual RC log(RC code, Level level) override;
+
+    /*
+    * Waits until the mapped records reach the file
+    */
+    virtual RC flush() override;
+
+    /*
+    * Writes the record count and truncates the file to the records written
+    */
+    virtual ~BinaryLogger();
+
+private:
+    struct Site {
+        const char* srcfile;
+        const char* function;
+        int line;
+
+        bool operator==(const Site& other) const;
+    };
+
+    struct SiteHash {
+        size_t operator()(const Site& site) const;
+    };
+
+    BinaryLogger(int fd, char* map, size_t capacity);
+
+    uint32_t siteOf(const char* srcfile, const char* function, int line);
+    uint32_t intern(const Site& site);
+    RC append(RC code, Level level, uint32_t site);
+
+    /*
+    * First of `count` consecutive records, nullptr if the file is full
+    */
+    binlog::Record* claim(size_t count);
+
+    int _fd;
+    char* _map;
+    size_t _capacity;
+    uint64_t _id;
+    std::chrono::steady_clock::time_point _start;
+
+    alignas(64) std::atomic<size_t> _next;
+    std::atomic<size_t> _dropped;
+
+    std::mutex _sitesMutex;
+    std::unordered_map<Site, uint32_t, SiteHash> _sites;
+};
@@ -0,0 +1,266 @@
+#include <thread>
+#include <vector>
+#include "ConcurrentSet.h"
+#include "RowStream.h"
+
+static std::atomic<size_t> nextStripe(0);
+static thread_local size_t threadStripe = nextStripe++;
+
+ConcurrentSet::ReadGuard::ReadGuard(ConcurrentSet const* set) {
+    _set = set;
+    if (!_set) {
+        return;
+    }
+    _stripe = threadStripe % stripes;
+    _version = _set->_version.load();
+    _set->_indicators[_version][_stripe].readers.fetch_add(1);
+    _published = _set->_published.load();
+}
+
+ISet const* ConcurrentSet::ReadGuard::get() const {
+    return _set ? _set->_replicas[_published] : nullptr;
+}
+
+ConcurrentSet::ReadGuard::~ReadGuard() {
+    if (_set) {
+        _set->_indicators[_version][_stripe].readers.fetch_sub(1, std::memory_order_release);
+    }
+}
+
+ConcurrentSet* ConcurrentSet::create(ILogger* logger, PRECISION precision) {
+    ISet* left = ISet::createSet(logger, precision);
+    ISet* right = ISet::createSet(logger, precision);
+    if (!left || !right) {
+        delete left;
+        delete right;
+        return nullptr;
+    }
+    return new ConcurrentSet(left, right);
+}
+
+ConcurrentSet::ConcurrentSet(ISet* left, ISet* right) {
+    _replicas[0] = left;
+    _replicas[1] = right;
+    _published = 0;
+    _version = 0;
+    for (auto& indicator : _indicators) {
+        for (Counter& counter : indicator) {
+            counter.readers = 0;
+        }
+    }
+}
+
+void ConcurrentSet::waitForReaders(size_t version) const {
+    for (Counter& counter : _indicators[version]) {
+        while (counter.readers.load() != 0) {
+            std::this_thread::yield();
+        }
+    }
+}
+
+template <typename Write>
+RC ConcurrentSet::modify(const Write& write) {
+    std::lock_guard<std::mutex> lock(_writeMutex);
+    size_t published = _published.load();
+    RC code = write(_replicas[1 - published]);
+    _published.store(1 - published);
+
+    // readers that could still see the old replica are counted in either indicator
+    size_t version = _version.load();
+    waitForReaders(1 - version);
+    _version.store(1 - version);
+    waitForReaders(version);
+
+    // replicas are deterministic, so the same change gives the same result on the other one
+    write(_replicas[published]);
+    return code;
+}
+
+size_t ConcurrentSet::getDim() const {
+    ReadGuard guard(this);
+    return guard.get()->getDim();
+}
+
+size_t ConcurrentSet::getSize() const {
+    ReadGuard guard(this);
+    return guard.get()->getSize();
+}
+
+ISet::PRECISION ConcurrentSet::getPrecision() const {
+    ReadGuard guard(this);
+    return guard.get()->getPrecision();
+}
+
+RC ConcurrentSet::get(size_t index, IVector const*& val) const {
+    ReadGuard guard(this);
+    return guard.get()->get(index, val);
+}
+
+RC ConcurrentSet::findFirst(IVector const * const& pat, IVector::NORM n, double tol, IVector const *& val) const {
+    ReadGuard guard(this);
+    return guard.get()->findFirst(pat, n, tol, val);
+}
+
+RC ConcurrentSet::getView(size_t, IVectorView&) const {
+    return RC::NOT_SUPPORTED;
+}
+
+RC ConcurrentSet::findFirstView(IVector const * const&, IVector::NORM, double, IVectorView&) const {
+    return RC::NOT_SUPPORTED;
+}
+
+RC ConcurrentSet::findAll(IVector const * const& pat, IVector::NORM n, double tol, std::vector<size_t>& indices) const {
+    ReadGuard guard(this);
+    return guard.get()->findAll(pat, n, tol, indices);
+}
+
+RC ConcurrentSet::findKNearest(IVector const * const& pat, IVector::NORM n, size_t k, std::vector<size_t>& indices, std::vector<double>& dists) const {
+    ReadGuard guard(this);
+    return guard.get()->findKNearest(pat, n, k, indices, dists);
+}
+
+RC ConcurrentSet::pairwiseDistances(ISet const* other, IVector::NORM n, std::vector<double>& out) const {
+    ReadGuard guard(this);
+    return guard.get()->pairwiseDistances(other, n, out);
+}
+
+RC ConcurrentSet::gram(std::vector<double>& out) const {
+    ReadGuard guard(this);
+    return guard.get()->gram(out);
+}
+
+RC ConcurrentSet::insert(IVector const *& val, IVector::NORM n, double tol) {
+    return modify([&](ISet* replica) { return replica->insert(val, n, tol); });
+}
+
+RC ConcurrentSet::insertBatch(double const* rows, size_t dim, size_t count, IVector::NORM n, double tol) {
+    return modify([&](ISet* replica) { return replica->insertBatch(rows, dim, count, n, tol); });
+}
+
+RC ConcurrentSet::insertStream(const RowReader& read, size_t dim, IVector::NORM n, double tol) {
+#ifndef FAST_MATH
+    if (!read) {
+        SendWarning(getLogger(), RC::NULLPTR_ERROR);
+        return RC::NULLPTR_ERROR;
+    }
+#endif
+    // checked in any build, the chunk is sized by it
+    if (dim == 0) {
+        SendWarning(getLogger(), RC::INVALID_ARGUMENT);
+        return RC::INVALID_ARGUMENT;
+    }
+    size_t capacity = rowstream::chunkRows(dim);
+    std::vector<double> chunk(capacity * dim);
+    for (;;) {
+        size_t count = read(chunk.data(), capacity);
+        if (count == 0) {
+            return RC::SUCCESS;
+        }
+        if (count > capacity) {
+            SendWarning(getLogger(), RC::INVALID_ARGUMENT);
+            return RC::INVALID_ARGUMENT;
+        }
+        RC code = insertBatch(chunk.data(), dim, count, n, tol);
+        if (code != RC::SUCCESS) {
+            return code;
+        }
+    }
+}
+
+RC ConcurrentSet::insertFile(const char* const& path, size_t dim, IVector::NORM n, double tol) {
+    // read once here rather than per replica, so both get the same rows whatever happens to the file meanwhile
+    return rowstream::insertFile(this, path, dim, n, tol);
+}
+
+RC ConcurrentSet::remove(size_t index) {
+    return modify([&](ISet* replica) { return replica->remove(index); });
+}
+
+RC ConcurrentSet::remove(IVector const * const& pat, IVector::NORM n, double tol) {
+    return modify([&](ISet* replica) { return replica->remove(pat, n, tol); });
+}
+
+RC ConcurrentSet::removeIf(const std::function<bool(double const* vec)>& predicate) {
+    return modify([&](ISet* replica) { return replica->removeIf(predicate); });
+}
+
+RC ConcurrentSet::setRemoveMode(REMOVE_MODE mode) {
+    return modify([&](ISet* replica) { return replica->setRemoveMode(mode); });
+}
+
+ISet::REMOVE_MODE ConcurrentSet::getRemoveMode() const {
+    ReadGuard guard(this);
+    return guard.get()->getRemoveMode();
+}
+
+RC ConcurrentSet::compact() {
+    return modify([&](ISet* replica) { return replica->compact(); });
+}
+
+RC ConcurrentSet::setIndex(INDEX type) {
+    return modify([&](ISet* replica) { return replica->setIndex(type); });
+}
+
+ISet::INDEX ConcurrentSet::getIndex() const {
+    ReadGuard guard(this);
+    return guard.get()->getIndex();
+}
+
+RC ConcurrentSet::reserve(size_t capacity) {
+    return modify([&](ISet* replica) { return replica->reserve(capacity); });
+}
+
+RC ConcurrentSet::shrinkToFit() {
+    return modify([&](ISet* replica) { return replica->shrinkToFit(); });
+}
+
+RC ConcurrentSet::setGrowthFactor(double factor) {
+    return modify([&](ISet* replica) { return replica->setGrowthFactor(factor); });
+}
+
+size_t ConcurrentSet::sizeAllocated() const {
+    std::lock_guard<std::mutex> lock(_writeMutex);
+    return sizeof(ConcurrentSet) + _replicas[0]->sizeAllocated() + _replicas[1]->sizeAllocated();
+}
+
+RC ConcurrentSet::getStats(Stats& stats) const {
+    Stats right;
+    RC code = _replicas[0]->getStats(stats);
+    if (code != RC::SUCCESS || (code = _replicas[1]->getStats(right)) != RC::SUCCESS) {
+        return code;
+    }
+    stats.distances += right.distances;
+    stats.candidates += right.candidates;
+    stats.pruned += right.pruned;
+    stats.reallocations += right.reallocations;
+    stats.bytesMoved += right.bytesMoved;
+    return RC::SUCCESS;
+}
+
+RC ConcurrentSet::resetStats() {
+    RC code = _replicas[0]->resetStats();
+    return code == RC::SUCCESS ? _replicas[1]->resetStats() : code;
+}
+
+RC ConcurrentSet::setStatsDump(size_t milliseconds) {
+    return modify([&](ISet* replica) { return replica->setStatsDump(milliseconds); });
+}
+
+RC ConcurrentSet::save(const char* const& path) const {
+    ReadGuard guard(this);
+    return guard.get()->save(path);
+}
+
+RC ConcurrentSet::attachLogger(ILogger* logger) {
+    return modify([&](ISet* replica) { return replica->attachLogger(logger); });
+}
+
+ILogger* ConcurrentSet::getLogger() const {
+    ReadGuard guard(this);
+    return guard.get()->getLogger();
+}
+
+ConcurrentSet::~ConcurrentSet() {
+    delete _replicas[0];
+    delete _replicas[1];
+}
@@ -0,0 +1,119 @@
+#pragma once
+#include <atomic>
+#include <mutex>
+#include "../include/ISet.h"
+
+/*
+* Set safe for many reading threads alongside writers
+*
+* Two identical replicas are kept (Left-Right scheme): readers announce themselves in a striped
+* read indicator and use the replica currently published for reading, they never block or retry.
+* Writers are serialized, apply a change to the hidden replica, publish it, wait until readers
+* have drained from the other one and apply the same change there
+*/
+class ConcurrentSet : public ISet {
+public:
+    /*
+    * Keeps the published replica readable for the lifetime of the guard, a null set gives a no-op guard
+    */
+    class ReadGuard {
+    public:
+        ReadGuard(ConcurrentSet const* set);
+        ISet const* get() const;
+        ~ReadGuard();
+
+    private:
+        ConcurrentSet const* _set;
+        size_t _version;
+        size_t _stripe;
+        size_t _published;
+    };
+
+    static ConcurrentSet* create(ILogger* logger, PRECISION precision);
+
+    virtual size_t getDim() const override;
+    virtual size_t getSize() const override;
+    virtual PRECISION getPrecision() const override;
+    virtual RC get(size_t index, IVector const*& val) const override;
+    virtual RC findFirst(IVector const * const& pat, IVector::NORM n, double tol, IVector const *& val) const override;
+
+    /*
+    * Views would outlive the read guard, use get() and findFirst() instead
+    */
+    virtual RC getView(size_t index, IVectorView& view) const override;
+    virtual RC findFirstView(IVector const * const& pat, IVector::NORM n, double tol, IVectorView& view) const override;
+    virtual RC findAll(IVector const * const& pat, IVector::NORM n, double tol, std::vector<size_t>& indices) const override;
+    virtual RC findKNearest(IVector const * const& pat, IVector::NORM n, size_t k, std::vector<size_t>& indices, std::vector<double>& dists) const override;
+    virtual RC pairwiseDistances(ISet const* other, IVector::NORM n, std::vector<double>& out) const override;
+    virtual RC gram(std::vector<double>& out) const override;
+
+    virtual RC insert(IVector const *& val, IVector::NORM n, double tol) override;
+    virtual RC insertBatch(double const* rows, size_t dim, size_t count, IVector::NORM n, double tol) override;
+
+    /*
+    * Every chunk read is applied to both replicas as an insertBatch(), readers may see the stream partly inserted
+    */
+    virtual RC insertStream(const RowReader& read, size_t dim, IVector::NORM n, double tol) override;
+    virtual RC insertFile(const char* const& path, size_t dim, IVector::NORM n, double tol) override;
+
+    virtual RC remove(size_t index) override;
+    virtual RC remove(IVector const * const& pat, IVector::NORM n, double tol) override;
+
+    /*
+    * Predicate runs once per replica, so it must give the same answer for the same vector
+    */
+    virtual RC removeIf(const std::function<bool(double const* vec)>& predicate) override;
+
+    virtual RC setRemoveMode(REMOVE_MODE mode) override;
+    virtual REMOVE_MODE getRemoveMode() const override;
+    virtual RC compact() override;
+
+    virtual RC setIndex(INDEX type) override;
+    virtual INDEX getIndex() const override;
+
+    virtual RC reserve(size_t capacity) override;
+    virtual RC shrinkToFit() override;
+    virtual RC setGrowthFactor(double factor) override;
+
+    /*
+    * Includes both replicas
+    */
+    virtual size_t sizeAllocated() const override;
+
+    /*
+    * Sums both replicas, so every modification is counted twice, each replica writes its own dumps
+    */
+    virtual RC getStats(Stats& stats) const override;
+    virtual RC resetStats() override;
+    virtual RC setStatsDump(size_t milliseconds) override;
+
+    virtual RC save(const char* const& path) const override;
+
+    virtual RC attachLogger(ILogger* logger) override;
+    virtual ILogger* getLogger() const override;
+
+    virtual ~ConcurrentSet();
+
+private:
+    static constexpr size_t stripes = 16;
+
+    struct alignas(64) Counter {
+        std::atomic<size_t> readers;
+    };
+
+    ConcurrentSet(ISet* left, ISet* right);
+
+    /*
+    * Runs `write` on both replicas, waiting for readers of the one being changed
+    */
+    template <typename Write>
+    RC modify(const Write& write);
+
+    void waitForReaders(size_t version) const;
+
+    ISet* _replicas[2];
+    std::atomic<size_t> _published;
+    std::atomic<size_t> _version;
+    mutable Counter _indicators[2][stripes];
+    mutable std::mutex _writeMutex;
+};
@@ -0,0 +1,95 @@
+#include <chrono>
+#include <new>
+#include "Counters.h"
+
+// direct-mapped, a collision costs one locked lookup
+constexpr size_t slotCacheSize = 16;
+
+static std::atomic<uint64_t> nextCountersId(1);
+
+namespace {
+
+struct CachedSlot {
+    uint64_t owner;
+    void* slot;
+};
+
+// owners are told apart by ids that are never reused, so entries of a destroyed owner just miss
+thread_local CachedSlot slotCache[slotCacheSize];
+
+int64_t now() {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+}
+
+Counters::Counters() {
+    _id = nextCountersId++;
+    for (std::atomic<uint64_t>& value : _baseline) {
+        value = 0;
+    }
+    _period = 0;
+    _due = 0;
+}
+
+Counters::Slot* Counters::local() {
+    CachedSlot& cached = slotCache[_id % slotCacheSize];
+    if (cached.owner == _id) {
+        return (Slot*)cached.slot;
+    }
+    std::lock_guard<std::mutex> guard(_mutex);
+    std::unique_ptr<Slot>& slot = _slots[std::this_thread::get_id()];
+    if (!slot) {
+        slot.reset(new (std::nothrow) Slot());
+        if (!slot) {
+            return nullptr;
+        }
+    }
+    cached = { _id, slot.get() };
+    return slot.get();
+}
+
+void Counters::add(Counter counter, uint64_t amount) {
+    Slot* slot = local();
+    if (!slot) {
+        return;
+    }
+    // the calling thread is the only writer of its slot
+    std::atomic<uint64_t>& value = slot->values[(size_t)counter];
+    value.store(value.load(std::memory_order_relaxed) + amount, std::memory_order_relaxed);
+}
+
+uint64_t Counters::sum(Counter counter) const {
+    std::lock_guard<std::mutex> guard(_mutex);
+    uint64_t res = 0;
+    for (auto const& slot : _slots) {
+        res += slot.second->values[(size_t)counter].load(std::memory_order_relaxed);
+    }
+    return res;
+}
+
+uint64_t Counters::get(Counter counter) const {
+    return sum(counter) - _baseline[(size_t)counter].load(std::memory_order_relaxed);
+}
+
+void Counters::reset() {
+    for (size_t i = 0; i < (size_t)Counter::AMOUNT; i++) {
+        _baseline[i].store(sum((Counter)i), std::memory_order_relaxed);
+    }
+}
+
+void Counters::setDumpPeriod(size_t milliseconds) {
+    int64_t period = (int64_t)milliseconds * 1000000;
+    _due.store(now() + period, std::memory_order_relaxed);
+    _period.store(period, std::memory_order_relaxed);
+}
+
+bool Counters::takeDump() {
+    int64_t period = _period.load(std::memory_order_relaxed);
+    if (period == 0) {
+        return false;
+    }
+    int64_t time = now();
+    int64_t due = _due.load(std::memory_order_relaxed);
+    return time >= due && _due.compare_exchange_strong(due, time + period, std::memory_order_relaxed);
+}
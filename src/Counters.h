@@ -0,0 +1,69 @@
+#pragma once
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <unordered_map>
+
+/*
+* Counting is compiled in only with COLLECT_STATS defined, otherwise COUNT_STAT evaluates nothing
+*/
+#ifdef COLLECT_STATS
+#define COUNT_STAT(Owner, Name, Amount) (Owner).add(Counters::Counter::Name, (Amount))
+#else
+#define COUNT_STAT(Owner, Name, Amount) ((void)sizeof(Amount))
+#endif
+
+/*
+* Work counters of one owner (a set, or all vectors)
+*
+* Every thread counts into a cache line of its own, found through a small thread-local cache, so counting is
+* a plain store that no other thread contends for. Reading sums the lines of all threads that ever counted
+*/
+class Counters {
+public:
+    enum class Counter {
+        DISTANCES,       // Distances from a pattern to a stored vector computed
+        CANDIDATES,      // Stored vectors compared with a pattern
+        PRUNED,          // Candidates rejected by their cached norm alone
+        REALLOCATIONS,   // Storage reallocations
+        BYTES_MOVED,     // Bytes of stored vectors moved by removals
+        ALLOCATIONS,     // Vectors created
+        BYTES_ALLOCATED, // Memory taken by created vectors
+        AMOUNT
+    };
+
+    Counters();
+
+    void add(Counter counter, uint64_t amount);
+    uint64_t get(Counter counter) const;
+
+    /*
+    * Counts start over from 0, the lines of other threads are left alone: their current sums become the baseline
+    */
+    void reset();
+
+    /*
+    * takeDump() returns true once per `milliseconds`, 0 (default) never
+    */
+    void setDumpPeriod(size_t milliseconds);
+    bool takeDump();
+
+private:
+    struct alignas(64) Slot {
+        std::atomic<uint64_t> values[(size_t)Counter::AMOUNT];
+    };
+
+    Slot* local();
+    uint64_t sum(Counter counter) const;
+
+    uint64_t _id;
+    mutable std::mutex _mutex;
+    std::unordered_map<std::thread::id, std::unique_ptr<Slot>> _slots;
+    std::atomic<uint64_t> _baseline[(size_t)Counter::AMOUNT];
+
+    // steady clock nanoseconds
+    std::atomic<int64_t> _period;
+    std::atomic<int64_t> _due;
+};
@@ -0,0 +1,1109 @@
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <cstdint>
+#include "Kernels.h"
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define KERNELS_X86
+#include <immintrin.h>
+#define TARGET_SSE2 __attribute__((target("sse2")))
+#define TARGET_AVX2 __attribute__((target("avx2,fma")))
+#define TARGET_AVX512 __attribute__((target("avx512f")))
+#endif
+
+namespace {
+
+struct Table {
+    kernels::ISA isa;
+    double (*sumAbs)(double const* x, size_t n);
+    double (*sumSquares)(double const* x, size_t n);
+    double (*maxAbs)(double const* x, size_t n);
+    double (*dot)(double const* x, double const* y, size_t n);
+    double (*distFirst)(double const* x, double const* y, size_t n);
+    double (*distSecondSquared)(double const* x, double const* y, size_t n);
+    double (*distChebyshev)(double const* x, double const* y, size_t n);
+    bool (*isFinite)(double const* x, size_t n);
+    void (*inc)(double* x, double const* y, size_t n);
+    void (*dec)(double* x, double const* y, size_t n);
+    void (*scale)(double* x, double m, size_t n);
+    void (*add)(double* out, double const* x, double const* y, size_t n);
+    void (*sub)(double* out, double const* x, double const* y, size_t n);
+    void (*axpy)(double* y, double a, double const* x, size_t n);
+    void (*lerp)(double* out, double const* x, double const* y, double t, size_t n);
+    double (*distFirstF32)(float const* x, double const* y, size_t n);
+    double (*distSecondSquaredF32)(float const* x, double const* y, size_t n);
+    double (*distChebyshevF32)(float const* x, double const* y, size_t n);
+};
+
+/*
+* Scalar
+*/
+
+double sumAbsScalar(double const* x, size_t n) {
+    double res = 0;
+    for (size_t i = 0; i < n; i++) {
+        res += fabs(x[i]);
+    }
+    return res;
+}
+
+double sumSquaresScalar(double const* x, size_t n) {
+    double res = 0;
+    for (size_t i = 0; i < n; i++) {
+        res += x[i] * x[i];
+    }
+    return res;
+}
+
+double maxAbsScalar(double const* x, size_t n) {
+    double res = 0;
+    for (size_t i = 0; i < n; i++) {
+        res = fmax(res, fabs(x[i]));
+    }
+    return res;
+}
+
+double dotScalar(double const* x, double const* y, size_t n) {
+    double res = 0;
+    for (size_t i = 0; i < n; i++) {
+        res += x[i] * y[i];
+    }
+    return res;
+}
+
+double distFirstScalar(double const* x, double const* y, size_t n) {
+    double res = 0;
+    for (size_t i = 0; i < n; i++) {
+        res += fabs(x[i] - y[i]);
+    }
+    return res;
+}
+
+double distSecondSquaredScalar(double const* x, double const* y, size_t n) {
+    double res = 0;
+    for (size_t i = 0; i < n; i++) {
+        double diff = x[i] - y[i];
+        res += diff * diff;
+    }
+    return res;
+}
+
+double distChebyshevScalar(double const* x, double const* y, size_t n) {
+    double res = 0;
+    for (size_t i = 0; i < n; i++) {
+        res = fmax(res, fabs(x[i] - y[i]));
+    }
+    return res;
+}
+
+// x * 0 is 0 for finite x and NaN otherwise, so a single sum checks the whole array
+bool isFiniteScalar(double const* x, size_t n) {
+    double res = 0;
+    for (size_t i = 0; i < n; i++) {
+        res += x[i] * 0.0;
+    }
+    return res == 0;
+}
+
+void incScalar(double* x, double const* y, size_t n) {
+    for (size_t i = 0; i < n; i++) {
+        x[i] += y[i];
+    }
+}
+
+void decScalar(double* x, double const* y, size_t n) {
+    for (size_t i = 0; i < n; i++) {
+        x[i] -= y[i];
+    }
+}
+
+void scaleScalar(double* x, double m, size_t n) {
+    for (size_t i = 0; i < n; i++) {
+        x[i] *= m;
+    }
+}
+
+void addScalar(double* out, double const* x, double const* y, size_t n) {
+    for (size_t i = 0; i < n; i++) {
+        out[i] = x[i] + y[i];
+    }
+}
+
+void subScalar(double* out, double const* x, double const* y, size_t n) {
+    for (size_t i = 0; i < n; i++) {
+        out[i] = x[i] - y[i];
+    }
+}
+
+void axpyScalar(double* y, double a, double const* x, size_t n) {
+    for (size_t i = 0; i < n; i++) {
+        y[i] += a * x[i];
+    }
+}
+
+void lerpScalar(double* out, double const* x, double const* y, double t, size_t n) {
+    for (size_t i = 0; i < n; i++) {
+        out[i] = x[i] + t * (y[i] - x[i]);
+    }
+}
+
+// float coordinates are widened before subtracting, so sums accumulate in double
+
+double distFirstF32Scalar(float const* x, double const* y, size_t n) {
+    double res = 0;
+    for (size_t i = 0; i < n; i++) {
+        res += fabs((double)x[i] - y[i]);
+    }
+    return res;
+}
+
+double distSecondSquaredF32Scalar(float const* x, double const* y, size_t n) {
+    double res = 0;
+    for (size_t i = 0; i < n; i++) {
+        double diff = (double)x[i] - y[i];
+        res += diff * diff;
+    }
+    return res;
+}
+
+double distChebyshevF32Scalar(float const* x, double const* y, size_t n) {
+    double res = 0;
+    for (size_t i = 0; i < n; i++) {
+        res = fmax(res, fabs((double)x[i] - y[i]));
+    }
+    return res;
+}
+
+const Table scalarTable = {
+    kernels::ISA::SCALAR,
+    sumAbsScalar, sumSquaresScalar, maxAbsScalar, dotScalar,
+    distFirstScalar, distSecondSquaredScalar, distChebyshevScalar,
+    isFiniteScalar, incScalar, decScalar, scaleScalar,
+    addScalar, subScalar, axpyScalar, lerpScalar,
+    distFirstF32Scalar, distSecondSquaredF32Scalar, distChebyshevF32Scalar,
+};
+
+#ifdef KERNELS_X86
+
+/*
+* SSE2
+*/
+
+TARGET_SSE2 inline __m128d absSse2(__m128d x) {
+    return _mm_andnot_pd(_mm_set1_pd(-0.0), x);
+}
+
+TARGET_SSE2 inline double hsumSse2(__m128d x) {
+    return _mm_cvtsd_f64(_mm_add_sd(x, _mm_unpackhi_pd(x, x)));
+}
+
+TARGET_SSE2 inline double hmaxSse2(__m128d x) {
+    return _mm_cvtsd_f64(_mm_max_sd(x, _mm_unpackhi_pd(x, x)));
+}
+
+TARGET_SSE2 double sumAbsSse2(double const* x, size_t n) {
+    __m128d acc0 = _mm_setzero_pd(), acc1 = _mm_setzero_pd();
+    size_t i = 0;
+    for (; i + 4 <= n; i += 4) {
+        acc0 = _mm_add_pd(acc0, absSse2(_mm_loadu_pd(x + i)));
+        acc1 = _mm_add_pd(acc1, absSse2(_mm_loadu_pd(x + i + 2)));
+    }
+    double res = hsumSse2(_mm_add_pd(acc0, acc1));
+    return res + sumAbsScalar(x + i, n - i);
+}
+
+TARGET_SSE2 double sumSquaresSse2(double const* x, size_t n) {
+    __m128d acc0 = _mm_setzero_pd(), acc1 = _mm_setzero_pd();
+    size_t i = 0;
+    for (; i + 4 <= n; i += 4) {
+        __m128d x0 = _mm_loadu_pd(x + i), x1 = _mm_loadu_pd(x + i + 2);
+        acc0 = _mm_add_pd(acc0, _mm_mul_pd(x0, x0));
+        acc1 = _mm_add_pd(acc1, _mm_mul_pd(x1, x1));
+    }
+    double res = hsumSse2(_mm_add_pd(acc0, acc1));
+    return res + sumSquaresScalar(x + i, n - i);
+}
+
+TARGET_SSE2 double maxAbsSse2(double const* x, size_t n) {
+    __m128d acc0 = _mm_setzero_pd(), acc1 = _mm_setzero_pd();
+    size_t i = 0;
+    for (; i + 4 <= n; i += 4) {
+        acc0 = _mm_max_pd(acc0, absSse2(_mm_loadu_pd(x + i)));
+        acc1 = _mm_max_pd(acc1, absSse2(_mm_loadu_pd(x + i + 2)));
+    }
+    double res = hmaxSse2(_mm_max_pd(acc0, acc1));
+    return fmax(res, maxAbsScalar(x + i, n - i));
+}
+
+TARGET_SSE2 double dotSse2(double const* x, double const* y, size_t n) {
+    __m128d acc0 = _mm_setzero_pd(), acc1 = _mm_setzero_pd();
+    size_t i = 0;
+    for (; i + 4 <= n; i += 4) {
+        acc0 = _mm_add_pd(acc0, _mm_mul_pd(_mm_loadu_pd(x + i), _mm_loadu_pd(y + i)));
+        acc1 = _mm_add_pd(acc1, _mm_mul_pd(_mm_loadu_pd(x + i + 2), _mm_loadu_pd(y + i + 2)));
+    }
+    double res = hsumSse2(_mm_add_pd(acc0, acc1));
+    return res + dotScalar(x + i, y + i, n - i);
+}
+
+TARGET_SSE2 double distFirstSse2(double const* x, double const* y, size_t n) {
+    __m128d acc0 = _mm_setzero_pd(), acc1 = _mm_setzero_pd();
+    size_t i = 0;
+    for (; i + 4 <= n; i += 4) {
+        acc0 = _mm_add_pd(acc0, absSse2(_mm_sub_pd(_mm_loadu_pd(x + i), _mm_loadu_pd(y + i))));
+        acc1 = _mm_add_pd(acc1, absSse2(_mm_sub_pd(_mm_loadu_pd(x + i + 2), _mm_loadu_pd(y + i + 2))));
+    }
+    double res = hsumSse2(_mm_add_pd(acc0, acc1));
+    return res + distFirstScalar(x + i, y + i, n - i);
+}
+
+TARGET_SSE2 double distSecondSquaredSse2(double const* x, double const* y, size_t n) {
+    __m128d acc0 = _mm_setzero_pd(), acc1 = _mm_setzero_pd();
+    size_t i = 0;
+    for (; i + 4 <= n; i += 4) {
+        __m128d d0 = _mm_sub_pd(_mm_loadu_pd(x + i), _mm_loadu_pd(y + i));
+        __m128d d1 = _mm_sub_pd(_mm_loadu_pd(x + i + 2), _mm_loadu_pd(y + i + 2));
+        acc0 = _mm_add_pd(acc0, _mm_mul_pd(d0, d0));
+        acc1 = _mm_add_pd(acc1, _mm_mul_pd(d1, d1));
+    }
+    double res = hsumSse2(_mm_add_pd(acc0, acc1));
+    return res + distSecondSquaredScalar(x + i, y + i, n - i);
+}
+
+TARGET_SSE2 double distChebyshevSse2(double const* x, double const* y, size_t n) {
+    __m128d acc0 = _mm_setzero_pd(), acc1 = _mm_setzero_pd();
+    size_t i = 0;
+    for (; i + 4 <= n; i += 4) {
+        acc0 = _mm_max_pd(acc0, absSse2(_mm_sub_pd(_mm_loadu_pd(x + i), _mm_loadu_pd(y + i))));
+        acc1 = _mm_max_pd(acc1, absSse2(_mm_sub_pd(_mm_loadu_pd(x + i + 2), _mm_loadu_pd(y + i + 2))));
+    }
+    double res = hmaxSse2(_mm_max_pd(acc0, acc1));
+    return fmax(res, distChebyshevScalar(x + i, y + i, n - i));
+}
+
+TARGET_SSE2 bool isFiniteSse2(double const* x, size_t n) {
+    __m128d zero = _mm_setzero_pd(), acc = _mm_setzero_pd();
+    size_t i = 0;
+    for (; i + 2 <= n; i += 2) {
+        acc = _mm_add_pd(acc, _mm_mul_pd(_mm_loadu_pd(x + i), zero));
+    }
+    return hsumSse2(acc) == 0 && isFiniteScalar(x + i, n - i);
+}
+
+TARGET_SSE2 void incSse2(double* x, double const* y, size_t n) {
+    size_t i = 0;
+    for (; i + 2 <= n; i += 2) {
+        _mm_storeu_pd(x + i, _mm_add_pd(_mm_loadu_pd(x + i), _mm_loadu_pd(y + i)));
+    }
+    incScalar(x + i, y + i, n - i);
+}
+
+TARGET_SSE2 void decSse2(double* x, double const* y, size_t n) {
+    size_t i = 0;
+    for (; i + 2 <= n; i += 2) {
+        _mm_storeu_pd(x + i, _mm_sub_pd(_mm_loadu_pd(x + i), _mm_loadu_pd(y + i)));
+    }
+    decScalar(x + i, y + i, n - i);
+}
+
+TARGET_SSE2 void scaleSse2(double* x, double m, size_t n) {
+    __m128d mul = _mm_set1_pd(m);
+    size_t i = 0;
+    for (; i + 2 <= n; i += 2) {
+        _mm_storeu_pd(x + i, _mm_mul_pd(_mm_loadu_pd(x + i), mul));
+    }
+    scaleScalar(x + i, m, n - i);
+}
+
+TARGET_SSE2 void addSse2(double* out, double const* x, double const* y, size_t n) {
+    size_t i = 0;
+    for (; i + 2 <= n; i += 2) {
+        _mm_storeu_pd(out + i, _mm_add_pd(_mm_loadu_pd(x + i), _mm_loadu_pd(y + i)));
+    }
+    addScalar(out + i, x + i, y + i, n - i);
+}
+
+TARGET_SSE2 void subSse2(double* out, double const* x, double const* y, size_t n) {
+    size_t i = 0;
+    for (; i + 2 <= n; i += 2) {
+        _mm_storeu_pd(out + i, _mm_sub_pd(_mm_loadu_pd(x + i), _mm_loadu_pd(y + i)));
+    }
+    subScalar(out + i, x + i, y + i, n - i);
+}
+
+TARGET_SSE2 void axpySse2(double* y, double a, double const* x, size_t n) {
+    __m128d mul = _mm_set1_pd(a);
+    size_t i = 0;
+    for (; i + 2 <= n; i += 2) {
+        _mm_storeu_pd(y + i, _mm_add_pd(_mm_loadu_pd(y + i), _mm_mul_pd(mul, _mm_loadu_pd(x + i))));
+    }
+    axpyScalar(y + i, a, x + i, n - i);
+}
+
+TARGET_SSE2 void lerpSse2(double* out, double const* x, double const* y, double t, size_t n) {
+    __m128d mul = _mm_set1_pd(t);
+    size_t i = 0;
+    for (; i + 2 <= n; i += 2) {
+        __m128d x0 = _mm_loadu_pd(x + i);
+        _mm_storeu_pd(out + i, _mm_add_pd(x0, _mm_mul_pd(mul, _mm_sub_pd(_mm_loadu_pd(y + i), x0))));
+    }
+    lerpScalar(out + i, x + i, y + i, t, n - i);
+}
+
+TARGET_SSE2 inline __m128d loadF32Sse2(float const* x) {
+    return _mm_cvtps_pd(_mm_castsi128_ps(_mm_loadl_epi64((__m128i const*)x)));
+}
+
+TARGET_SSE2 double distFirstF32Sse2(float const* x, double const* y, size_t n) {
+    __m128d acc0 = _mm_setzero_pd(), acc1 = _mm_setzero_pd();
+    size_t i = 0;
+    for (; i + 4 <= n; i += 4) {
+        acc0 = _mm_add_pd(acc0, absSse2(_mm_sub_pd(loadF32Sse2(x + i), _mm_loadu_pd(y + i))));
+        acc1 = _mm_add_pd(acc1, absSse2(_mm_sub_pd(loadF32Sse2(x + i + 2), _mm_loadu_pd(y + i + 2))));
+    }
+    double res = hsumSse2(_mm_add_pd(acc0, acc1));
+    return res + distFirstF32Scalar(x + i, y + i, n - i);
+}
+
+TARGET_SSE2 double distSecondSquaredF32Sse2(float const* x, double const* y, size_t n) {
+    __m128d acc0 = _mm_setzero_pd(), acc1 = _mm_setzero_pd();
+    size_t i = 0;
+    for (; i + 4 <= n; i += 4) {
+        __m128d d0 = _mm_sub_pd(loadF32Sse2(x + i), _mm_loadu_pd(y + i));
+        __m128d d1 = _mm_sub_pd(loadF32Sse2(x + i + 2), _mm_loadu_pd(y + i + 2));
+        acc0 = _mm_add_pd(acc0, _mm_mul_pd(d0, d0));
+        acc1 = _mm_add_pd(acc1, _mm_mul_pd(d1, d1));
+    }
+    double res = hsumSse2(_mm_add_pd(acc0, acc1));
+    return res + distSecondSquaredF32Scalar(x + i, y + i, n - i);
+}
+
+TARGET_SSE2 double distChebyshevF32Sse2(float const* x, double const* y, size_t n) {
+    __m128d acc0 = _mm_setzero_pd(), acc1 = _mm_setzero_pd();
+    size_t i = 0;
+    for (; i + 4 <= n; i += 4) {
+        acc0 = _mm_max_pd(acc0, absSse2(_mm_sub_pd(loadF32Sse2(x + i), _mm_loadu_pd(y + i))));
+        acc1 = _mm_max_pd(acc1, absSse2(_mm_sub_pd(loadF32Sse2(x + i + 2), _mm_loadu_pd(y + i + 2))));
+    }
+    double res = hmaxSse2(_mm_max_pd(acc0, acc1));
+    return fmax(res, distChebyshevF32Scalar(x + i, y + i, n - i));
+}
+
+const Table sse2Table = {
+    kernels::ISA::SSE2,
+    sumAbsSse2, sumSquaresSse2, maxAbsSse2, dotSse2,
+    distFirstSse2, distSecondSquaredSse2, distChebyshevSse2,
+    isFiniteSse2, incSse2, decSse2, scaleSse2,
+    addSse2, subSse2, axpySse2, lerpSse2,
+    distFirstF32Sse2, distSecondSquaredF32Sse2, distChebyshevF32Sse2,
+};
+
+/*
+* AVX2 + FMA
+*/
+
+TARGET_AVX2 inline __m256d absAvx2(__m256d x) {
+    return _mm256_andnot_pd(_mm256_set1_pd(-0.0), x);
+}
+
+TARGET_AVX2 inline double hsumAvx2(__m256d x) {
+    __m128d half = _mm_add_pd(_mm256_castpd256_pd128(x), _mm256_extractf128_pd(x, 1));
+    return _mm_cvtsd_f64(_mm_add_sd(half, _mm_unpackhi_pd(half, half)));
+}
+
+TARGET_AVX2 inline double hmaxAvx2(__m256d x) {
+    __m128d half = _mm_max_pd(_mm256_castpd256_pd128(x), _mm256_extractf128_pd(x, 1));
+    return _mm_cvtsd_f64(_mm_max_sd(half, _mm_unpackhi_pd(half, half)));
+}
+
+TARGET_AVX2 double sumAbsAvx2(double const* x, size_t n) {
+    __m256d acc0 = _mm256_setzero_pd(), acc1 = _mm256_setzero_pd();
+    size_t i = 0;
+    for (; i + 8 <= n; i += 8) {
+        acc0 = _mm256_add_pd(acc0, absAvx2(_mm256_loadu_pd(x + i)));
+        acc1 = _mm256_add_pd(acc1, absAvx2(_mm256_loadu_pd(x + i + 4)));
+    }
+    double res = hsumAvx2(_mm256_add_pd(acc0, acc1));
+    return res + sumAbsScalar(x + i, n - i);
+}
+
+TARGET_AVX2 double sumSquaresAvx2(double const* x, size_t n) {
+    __m256d acc0 = _mm256_setzero_pd(), acc1 = _mm256_setzero_pd();
+    size_t i = 0;
+    for (; i + 8 <= n; i += 8) {
+        __m256d x0 = _mm256_loadu_pd(x + i), x1 = _mm256_loadu_pd(x + i + 4);
+        acc0 = _mm256_fmadd_pd(x0, x0, acc0);
+        acc1 = _mm256_fmadd_pd(x1, x1, acc1);
+    }
+    double res = hsumAvx2(_mm256_add_pd(acc0, acc1));
+    return res + sumSquaresScalar(x + i, n - i);
+}
+
+TARGET_AVX2 double maxAbsAvx2(double const* x, size_t n) {
+    __m256d acc0 = _mm256_setzero_pd(), acc1 = _mm256_setzero_pd();
+    size_t i = 0;
+    for (; i + 8 <= n; i += 8) {
+        acc0 = _mm256_max_pd(acc0, absAvx2(_mm256_loadu_pd(x + i)));
+        acc1 = _mm256_max_pd(acc1, absAvx2(_mm256_loadu_pd(x + i + 4)));
+    }
+    double res = hmaxAvx2(_mm256_max_pd(acc0, acc1));
+    return fmax(res, maxAbsScalar(x + i, n - i));
+}
+
+TARGET_AVX2 double dotAvx2(double const* x, double const* y, size_t n) {
+    __m256d acc0 = _mm256_setzero_pd(), acc1 = _mm256_setzero_pd();
+    size_t i = 0;
+    for (; i + 8 <= n; i += 8) {
+        acc0 = _mm256_fmadd_pd(_mm256_loadu_pd(x + i), _mm256_loadu_pd(y + i), acc0);
+        acc1 = _mm256_fmadd_pd(_mm256_loadu_pd(x + i + 4), _mm256_loadu_pd(y + i + 4), acc1);
+    }
+    double res = hsumAvx2(_mm256_add_pd(acc0, acc1));
+    return res + dotScalar(x + i, y + i, n - i);
+}
+
+TARGET_AVX2 double distFirstAvx2(double const* x, double const* y, size_t n) {
+    __m256d acc0 = _mm256_setzero_pd(), acc1 = _mm256_setzero_pd();
+    size_t i = 0;
+    for (; i + 8 <= n; i += 8) {
+        acc0 = _mm256_add_pd(acc0, absAvx2(_mm256_sub_pd(_mm256_loadu_pd(x + i), _mm256_loadu_pd(y + i))));
+        acc1 = _mm256_add_pd(acc1, absAvx2(_mm256_sub_pd(_mm256_loadu_pd(x + i + 4), _mm256_loadu_pd(y + i + 4))));
+    }
+    double res = hsumAvx2(_mm256_add_pd(acc0, acc1));
+    return res + distFirstScalar(x + i, y + i, n - i);
+}
+
+TARGET_AVX2 double distSecondSquaredAvx2(double const* x, double const* y, size_t n) {
+    __m256d acc0 = _mm256_setzero_pd(), acc1 = _mm256_setzero_pd();
+    size_t i = 0;
+    for (; i + 8 <= n; i += 8) {
+        __m256d d0 = _mm256_sub_pd(_mm256_loadu_pd(x + i), _mm256_loadu_pd(y + i));
+        __m256d d1 = _mm256_sub_pd(_mm256_loadu_pd(x + i + 4), _mm256_loadu_pd(y + i + 4));
+        acc0 = _mm256_fmadd_pd(d0, d0, acc0);
+        acc1 = _mm256_fmadd_pd(d1, d1, acc1);
+    }
+    double res = hsumAvx2(_mm256_add_pd(acc0, acc1));
+    return res + distSecondSquaredScalar(x + i, y + i, n - i);
+}
+
+TARGET_AVX2 double distChebyshevAvx2(double const* x, double const* y, size_t n) {
+    __m256d acc0 = _mm256_setzero_pd(), acc1 = _mm256_setzero_pd();
+    size_t i = 0;
+    for (; i + 8 <= n; i += 8) {
+        acc0 = _mm256_max_pd(acc0, absAvx2(_mm256_sub_pd(_mm256_loadu_pd(x + i), _mm256_loadu_pd(y + i))));
+        acc1 = _mm256_max_pd(acc1, absAvx2(_mm256_sub_pd(_mm256_loadu_pd(x + i + 4), _mm256_loadu_pd(y + i + 4))));
+    }
+    double res = hmaxAvx2(_mm256_max_pd(acc0, acc1));
+    return fmax(res, distChebyshevScalar(x + i, y + i, n - i));
+}
+
+TARGET_AVX2 bool isFiniteAvx2(double const* x, size_t n) {
+    __m256d zero = _mm256_setzero_pd(), acc = _mm256_setzero_pd();
+    size_t i = 0;
+    for (; i + 4 <= n; i += 4) {
+        acc = _mm256_fmadd_pd(_mm256_loadu_pd(x + i), zero, acc);
+    }
+    return hsumAvx2(acc) == 0 && isFiniteScalar(x + i, n - i);
+}
+
+TARGET_AVX2 void incAvx2(double* x, double const* y, size_t n) {
+    size_t i = 0;
+    for (; i + 4 <= n; i += 4) {
+        _mm256_storeu_pd(x + i, _mm256_add_pd(_mm256_loadu_pd(x + i), _mm256_loadu_pd(y + i)));
+    }
+    incScalar(x + i, y + i, n - i);
+}
+
+TARGET_AVX2 void decAvx2(double* x, double const* y, size_t n) {
+    size_t i = 0;
+    for (; i + 4 <= n; i += 4) {
+        _mm256_storeu_pd(x + i, _mm256_sub_pd(_mm256_loadu_pd(x + i), _mm256_loadu_pd(y + i)));
+    }
+    decScalar(x + i, y + i, n - i);
+}
+
+TARGET_AVX2 void scaleAvx2(double* x, double m, size_t n) {
+    __m256d mul = _mm256_set1_pd(m);
+    size_t i = 0;
+    for (; i + 4 <= n; i += 4) {
+        _mm256_storeu_pd(x + i, _mm256_mul_pd(_mm256_loadu_pd(x + i), mul));
+    }
+    scaleScalar(x + i, m, n - i);
+}
+
+TARGET_AVX2 void addAvx2(double* out, double const* x, double const* y, size_t n) {
+    size_t i = 0;
+    for (; i + 4 <= n; i += 4) {
+        _mm256_storeu_pd(out + i, _mm256_add_pd(_mm256_loadu_pd(x + i), _mm256_loadu_pd(y + i)));
+    }
+    addScalar(out + i, x + i, y + i, n - i);
+}
+
+TARGET_AVX2 void subAvx2(double* out, double const* x, double const* y, size_t n) {
+    size_t i = 0;
+    for (; i + 4 <= n; i += 4) {
+        _mm256_storeu_pd(out + i, _mm256_sub_pd(_mm256_loadu_pd(x + i), _mm256_loadu_pd(y + i)));
+    }
+    subScalar(out + i, x + i, y + i, n - i);
+}
+
+TARGET_AVX2 void axpyAvx2(double* y, double a, double const* x, size_t n) {
+    __m256d mul = _mm256_set1_pd(a);
+    size_t i = 0;
+    for (; i + 4 <= n; i += 4) {
+        _mm256_storeu_pd(y + i, _mm256_fmadd_pd(mul, _mm256_loadu_pd(x + i), _mm256_loadu_pd(y + i)));
+    }
+    axpyScalar(y + i, a, x + i, n - i);
+}
+
+TARGET_AVX2 void lerpAvx2(double* out, double const* x, double const* y, double t, size_t n) {
+    __m256d mul = _mm256_set1_pd(t);
+    size_t i = 0;
+    for (; i + 4 <= n; i += 4) {
+        __m256d x0 = _mm256_loadu_pd(x + i);
+        _mm256_storeu_pd(out + i, _mm256_fmadd_pd(mul, _mm256_sub_pd(_mm256_loadu_pd(y + i), x0), x0));
+    }
+    lerpScalar(out + i, x + i, y + i, t, n - i);
+}
+
+TARGET_AVX2 double distFirstF32Avx2(float const* x, double const* y, size_t n) {
+    __m256d acc0 = _mm256_setzero_pd(), acc1 = _mm256_setzero_pd();
+    size_t i = 0;
+    for (; i + 8 <= n; i += 8) {
+        acc0 = _mm256_add_pd(acc0, absAvx2(_mm256_sub_pd(_mm256_cvtps_pd(_mm_loadu_ps(x + i)), _mm256_loadu_pd(y + i))));
+        acc1 = _mm256_add_pd(acc1, absAvx2(_mm256_sub_pd(_mm256_cvtps_pd(_mm_loadu_ps(x + i + 4)), _mm256_loadu_pd(y + i + 4))));
+    }
+    double res = hsumAvx2(_mm256_add_pd(acc0, acc1));
+    return res + distFirstF32Scalar(x + i, y + i, n - i);
+}
+
+TARGET_AVX2 double distSecondSquaredF32Avx2(float const* x, double const* y, size_t n) {
+    __m256d acc0 = _mm256_setzero_pd(), acc1 = _mm256_setzero_pd();
+    size_t i = 0;
+    for (; i + 8 <= n; i += 8) {
+        __m256d d0 = _mm256_sub_pd(_mm256_cvtps_pd(_mm_loadu_ps(x + i)), _mm256_loadu_pd(y + i));
+        __m256d d1 = _mm256_sub_pd(_mm256_cvtps_pd(_mm_loadu_ps(x + i + 4)), _mm256_loadu_pd(y + i + 4));
+        acc0 = _mm256_fmadd_pd(d0, d0, acc0);
+        acc1 = _mm256_fmadd_pd(d1, d1, acc1);
+    }
+    double res = hsumAvx2(_mm256_add_pd(acc0, acc1));
+    return res + distSecondSquaredF32Scalar(x + i, y + i, n - i);
+}
+
+TARGET_AVX2 double distChebyshevF32Avx2(float const* x, double const* y, size_t n) {
+    __m256d acc0 = _mm256_setzero_pd(), acc1 = _mm256_setzero_pd();
+    size_t i = 0;
+    for (; i + 8 <= n; i += 8) {
+        acc0 = _mm256_max_pd(acc0, absAvx2(_mm256_sub_pd(_mm256_cvtps_pd(_mm_loadu_ps(x + i)), _mm256_loadu_pd(y + i))));
+        acc1 = _mm256_max_pd(acc1, absAvx2(_mm256_sub_pd(_mm256_cvtps_pd(_mm_loadu_ps(x + i + 4)), _mm256_loadu_pd(y + i + 4))));
+    }
+    double res = hmaxAvx2(_mm256_max_pd(acc0, acc1));
+    return fmax(res, distChebyshevF32Scalar(x + i, y + i, n - i));
+}
+
+const Table avx2Table = {
+    kernels::ISA::AVX2,
+    sumAbsAvx2, sumSquaresAvx2, maxAbsAvx2, dotAvx2,
+    distFirstAvx2, distSecondSquaredAvx2, distChebyshevAvx2,
+    isFiniteAvx2, incAvx2, decAvx2, scaleAvx2,
+    addAvx2, subAvx2, axpyAvx2, lerpAvx2,
+    distFirstF32Avx2, distSecondSquaredF32Avx2, distChebyshevF32Avx2,
+};
+
+/*
+* AVX-512, tails are handled with masked loads instead of scalar loops
+*/
+
+TARGET_AVX512 inline __mmask8 tailMask(size_t left) {
+    return (__mmask8)((1u << left) - 1);
+}
+
+TARGET_AVX512 double sumAbsAvx512(double const* x, size_t n) {
+    __m512d acc0 = _mm512_setzero_pd(), acc1 = _mm512_setzero_pd();
+    size_t i = 0;
+    for (; i + 16 <= n; i += 16) {
+        acc0 = _mm512_add_pd(acc0, _mm512_abs_pd(_mm512_loadu_pd(x + i)));
+        acc1 = _mm512_add_pd(acc1, _mm512_abs_pd(_mm512_loadu_pd(x + i + 8)));
+    }
+    for (; i < n; i += 8) {
+        __mmask8 mask = n - i >= 8 ? 0xFF : tailMask(n - i);
+        acc0 = _mm512_add_pd(acc0, _mm512_abs_pd(_mm512_maskz_loadu_pd(mask, x + i)));
+    }
+    return _mm512_reduce_add_pd(_mm512_add_pd(acc0, acc1));
+}
+
+TARGET_AVX512 double sumSquaresAvx512(double const* x, size_t n) {
+    __m512d acc0 = _mm512_setzero_pd(), acc1 = _mm512_setzero_pd();
+    size_t i = 0;
+    for (; i + 16 <= n; i += 16) {
+        __m512d x0 = _mm512_loadu_pd(x + i), x1 = _mm512_loadu_pd(x + i + 8);
+        acc0 = _mm512_fmadd_pd(x0, x0, acc0);
+        acc1 = _mm512_fmadd_pd(x1, x1, acc1);
+    }
+    for (; i < n; i += 8) {
+        __mmask8 mask = n - i >= 8 ? 0xFF : tailMask(n - i);
+        __m512d x0 = _mm512_maskz_loadu_pd(mask, x + i);
+        acc0 = _mm512_fmadd_pd(x0, x0, acc0);
+    }
+    return _mm512_reduce_add_pd(_mm512_add_pd(acc0, acc1));
+}
+
+TARGET_AVX512 double maxAbsAvx512(double const* x, size_t n) {
+    __m512d acc0 = _mm512_setzero_pd(), acc1 = _mm512_setzero_pd();
+    size_t i = 0;
+    for (; i + 16 <= n; i += 16) {
+        acc0 = _mm512_max_pd(acc0, _mm512_abs_pd(_mm512_loadu_pd(x + i)));
+        acc1 = _mm512_max_pd(acc1, _mm512_abs_pd(_mm512_loadu_pd(x + i + 8)));
+    }
+    for (; i < n; i += 8) {
+        __mmask8 mask = n - i >= 8 ? 0xFF : tailMask(n - i);
+        acc0 = _mm512_max_pd(acc0, _mm512_abs_pd(_mm512_maskz_loadu_pd(mask, x + i)));
+    }
+    return _mm512_reduce_max_pd(_mm512_max_pd(acc0, acc1));
+}
+
+TARGET_AVX512 double dotAvx512(double const* x, double const* y, size_t n) {
+    __m512d acc0 = _mm512_setzero_pd(), acc1 = _mm512_setzero_pd();
+    size_t i = 0;
+    for (; i + 16 <= n; i += 16) {
+        acc0 = _mm512_fmadd_pd(_mm512_loadu_pd(x + i), _mm512_loadu_pd(y + i), acc0);
+        acc1 = _mm512_fmadd_pd(_mm512_loadu_pd(x + i + 8), _mm512_loadu_pd(y + i + 8), acc1);
+    }
+    for (; i < n; i += 8) {
+        __mmask8 mask = n - i >= 8 ? 0xFF : tailMask(n - i);
+        acc0 = _mm512_fmadd_pd(_mm512_maskz_loadu_pd(mask, x + i), _mm512_maskz_loadu_pd(mask, y + i), acc0);
+    }
+    return _mm512_reduce_add_pd(_mm512_add_pd(acc0, acc1));
+}
+
+TARGET_AVX512 double distFirstAvx512(double const* x, double const* y, size_t n) {
+    __m512d acc0 = _mm512_setzero_pd(), acc1 = _mm512_setzero_pd();
+    size_t i = 0;
+    for (; i + 16 <= n; i += 16) {
+        acc0 = _mm512_add_pd(acc0, _mm512_abs_pd(_mm512_sub_pd(_mm512_loadu_pd(x + i), _mm512_loadu_pd(y + i))));
+        acc1 = _mm512_add_pd(acc1, _mm512_abs_pd(_mm512_sub_pd(_mm512_loadu_pd(x + i + 8), _mm512_loadu_pd(y + i + 8))));
+    }
+    for (; i < n; i += 8) {
+        __mmask8 mask = n - i >= 8 ? 0xFF : tailMask(n - i);
+        __m512d diff = _mm512_sub_pd(_mm512_maskz_loadu_pd(mask, x + i), _mm512_maskz_loadu_pd(mask, y + i));
+        acc0 = _mm512_add_pd(acc0, _mm512_abs_pd(diff));
+    }
+    return _mm512_reduce_add_pd(_mm512_add_pd(acc0, acc1));
+}
+
+TARGET_AVX512 double distSecondSquaredAvx512(double const* x, double const* y, size_t n) {
+    __m512d acc0 = _mm512_setzero_pd(), acc1 = _mm512_setzero_pd();
+    size_t i = 0;
+    for (; i + 16 <= n; i += 16) {
+        __m512d d0 = _mm512_sub_pd(_mm512_loadu_pd(x + i), _mm512_loadu_pd(y + i));
+        __m512d d1 = _mm512_sub_pd(_mm512_loadu_pd(x + i + 8), _mm512_loadu_pd(y + i + 8));
+        acc0 = _mm512_fmadd_pd(d0, d0, acc0);
+        acc1 = _mm512_fmadd_pd(d1, d1, acc1);
+    }
+    for (; i < n; i += 8) {
+        __mmask8 mask = n - i >= 8 ? 0xFF : tailMask(n - i);
+        __m512d diff = _mm512_sub_pd(_mm512_maskz_loadu_pd(mask, x + i), _mm512_maskz_loadu_pd(mask, y + i));
+        acc0 = _mm512_fmadd_pd(diff, diff, acc0);
+    }
+    return _mm512_reduce_add_pd(_mm512_add_pd(acc0, acc1));
+}
+
+TARGET_AVX512 double distChebyshevAvx512(double const* x, double const* y, size_t n) {
+    __m512d acc0 = _mm512_setzero_pd(), acc1 = _mm512_setzero_pd();
+    size_t i = 0;
+    for (; i + 16 <= n; i += 16) {
+        acc0 = _mm512_max_pd(acc0, _mm512_abs_pd(_mm512_sub_pd(_mm512_loadu_pd(x + i), _mm512_loadu_pd(y + i))));
+        acc1 = _mm512_max_pd(acc1, _mm512_abs_pd(_mm512_sub_pd(_mm512_loadu_pd(x + i + 8), _mm512_loadu_pd(y + i + 8))));
+    }
+    for (; i < n; i += 8) {
+        __mmask8 mask = n - i >= 8 ? 0xFF : tailMask(n - i);
+        __m512d diff = _mm512_sub_pd(_mm512_maskz_loadu_pd(mask, x + i), _mm512_maskz_loadu_pd(mask, y + i));
+        acc0 = _mm512_max_pd(acc0, _mm512_abs_pd(diff));
+    }
+    return _mm512_reduce_max_pd(_mm512_max_pd(acc0, acc1));
+}
+
+TARGET_AVX512 bool isFiniteAvx512(double const* x, size_t n) {
+    __m512d zero = _mm512_setzero_pd(), acc = _mm512_setzero_pd();
+    for (size_t i = 0; i < n; i += 8) {
+        __mmask8 mask = n - i >= 8 ? 0xFF : tailMask(n - i);
+        acc = _mm512_fmadd_pd(_mm512_maskz_loadu_pd(mask, x + i), zero, acc);
+    }
+    return _mm512_reduce_add_pd(acc) == 0;
+}
+
+TARGET_AVX512 void incAvx512(double* x, double const* y, size_t n) {
+    for (size_t i = 0; i < n; i += 8) {
+        __mmask8 mask = n - i >= 8 ? 0xFF : tailMask(n - i);
+        __m512d sum = _mm512_add_pd(_mm512_maskz_loadu_pd(mask, x + i), _mm512_maskz_loadu_pd(mask, y + i));
+        _mm512_mask_storeu_pd(x + i, mask, sum);
+    }
+}
+
+TARGET_AVX512 void decAvx512(double* x, double const* y, size_t n) {
+    for (size_t i = 0; i < n; i += 8) {
+        __mmask8 mask = n - i >= 8 ? 0xFF : tailMask(n - i);
+        __m512d diff = _mm512_sub_pd(_mm512_maskz_loadu_pd(mask, x + i), _mm512_maskz_loadu_pd(mask, y + i));
+        _mm512_mask_storeu_pd(x + i, mask, diff);
+    }
+}
+
+TARGET_AVX512 void scaleAvx512(double* x, double m, size_t n) {
+    __m512d mul = _mm512_set1_pd(m);
+    for (size_t i = 0; i < n; i += 8) {
+        __mmask8 mask = n - i >= 8 ? 0xFF : tailMask(n - i);
+        _mm512_mask_storeu_pd(x + i, mask, _mm512_mul_pd(_mm512_maskz_loadu_pd(mask, x + i), mul));
+    }
+}
+
+TARGET_AVX512 void addAvx512(double* out, double const* x, double const* y, size_t n) {
+    for (size_t i = 0; i < n; i += 8) {
+        __mmask8 mask = n - i >= 8 ? 0xFF : tailMask(n - i);
+        __m512d sum = _mm512_add_pd(_mm512_maskz_loadu_pd(mask, x + i), _mm512_maskz_loadu_pd(mask, y + i));
+        _mm512_mask_storeu_pd(out + i, mask, sum);
+    }
+}
+
+TARGET_AVX512 void subAvx512(double* out, double const* x, double const* y, size_t n) {
+    for (size_t i = 0; i < n; i += 8) {
+        __mmask8 mask = n - i >= 8 ? 0xFF : tailMask(n - i);
+        __m512d diff = _mm512_sub_pd(_mm512_maskz_loadu_pd(mask, x + i), _mm512_maskz_loadu_pd(mask, y + i));
+        _mm512_mask_storeu_pd(out + i, mask, diff);
+    }
+}
+
+TARGET_AVX512 void axpyAvx512(double* y, double a, double const* x, size_t n) {
+    __m512d mul = _mm512_set1_pd(a);
+    for (size_t i = 0; i < n; i += 8) {
+        __mmask8 mask = n - i >= 8 ? 0xFF : tailMask(n - i);
+        __m512d res = _mm512_fmadd_pd(mul, _mm512_maskz_loadu_pd(mask, x + i), _mm512_maskz_loadu_pd(mask, y + i));
+        _mm512_mask_storeu_pd(y + i, mask, res);
+    }
+}
+
+TARGET_AVX512 void lerpAvx512(double* out, double const* x, double const* y, double t, size_t n) {
+    __m512d mul = _mm512_set1_pd(t);
+    for (size_t i = 0; i < n; i += 8) {
+        __mmask8 mask = n - i >= 8 ? 0xFF : tailMask(n - i);
+        __m512d x0 = _mm512_maskz_loadu_pd(mask, x + i);
+        __m512d res = _mm512_fmadd_pd(mul, _mm512_sub_pd(_mm512_maskz_loadu_pd(mask, y + i), x0), x0);
+        _mm512_mask_storeu_pd(out + i, mask, res);
+    }
+}
+
+// masked 512-bit float load keeps the tail within AVX-512F, the low half holds the 8 needed floats
+TARGET_AVX512 inline __m512d loadF32Avx512(__mmask8 mask, float const* x) {
+    return _mm512_cvtps_pd(_mm512_castps512_ps256(_mm512_maskz_loadu_ps((__mmask16)mask, x)));
+}
+
+TARGET_AVX512 double distFirstF32Avx512(float const* x, double const* y, size_t n) {
+    __m512d acc0 = _mm512_setzero_pd(), acc1 = _mm512_setzero_pd();
+    size_t i = 0;
+    for (; i + 16 <= n; i += 16) {
+        acc0 = _mm512_add_pd(acc0, _mm512_abs_pd(_mm512_sub_pd(_mm512_cvtps_pd(_mm256_loadu_ps(x + i)), _mm512_loadu_pd(y + i))));
+        acc1 = _mm512_add_pd(acc1, _mm512_abs_pd(_mm512_sub_pd(_mm512_cvtps_pd(_mm256_loadu_ps(x + i + 8)), _mm512_loadu_pd(y + i + 8))));
+    }
+    for (; i < n; i += 8) {
+        __mmask8 mask = n - i >= 8 ? 0xFF : tailMask(n - i);
+        __m512d diff = _mm512_sub_pd(loadF32Avx512(mask, x + i), _mm512_maskz_loadu_pd(mask, y + i));
+        acc0 = _mm512_add_pd(acc0, _mm512_abs_pd(diff));
+    }
+    return _mm512_reduce_add_pd(_mm512_add_pd(acc0, acc1));
+}
+
+TARGET_AVX512 double distSecondSquaredF32Avx512(float const* x, double const* y, size_t n) {
+    __m512d acc0 = _mm512_setzero_pd(), acc1 = _mm512_setzero_pd();
+    size_t i = 0;
+    for (; i + 16 <= n; i += 16) {
+        __m512d d0 = _mm512_sub_pd(_mm512_cvtps_pd(_mm256_loadu_ps(x + i)), _mm512_loadu_pd(y + i));
+        __m512d d1 = _mm512_sub_pd(_mm512_cvtps_pd(_mm256_loadu_ps(x + i + 8)), _mm512_loadu_pd(y + i + 8));
+        acc0 = _mm512_fmadd_pd(d0, d0, acc0);
+        acc1 = _mm512_fmadd_pd(d1, d1, acc1);
+    }
+    for (; i < n; i += 8) {
+        __mmask8 mask = n - i >= 8 ? 0xFF : tailMask(n - i);
+        __m512d diff = _mm512_sub_pd(loadF32Avx512(mask, x + i), _mm512_maskz_loadu_pd(mask, y + i));
+        acc0 = _mm512_fmadd_pd(diff, diff, acc0);
+    }
+    return _mm512_reduce_add_pd(_mm512_add_pd(acc0, acc1));
+}
+
+TARGET_AVX512 double distChebyshevF32Avx512(float const* x, double const* y, size_t n) {
+    __m512d acc0 = _mm512_setzero_pd(), acc1 = _mm512_setzero_pd();
+    size_t i = 0;
+    for (; i + 16 <= n; i += 16) {
+        acc0 = _mm512_max_pd(acc0, _mm512_abs_pd(_mm512_sub_pd(_mm512_cvtps_pd(_mm256_loadu_ps(x + i)), _mm512_loadu_pd(y + i))));
+        acc1 = _mm512_max_pd(acc1, _mm512_abs_pd(_mm512_sub_pd(_mm512_cvtps_pd(_mm256_loadu_ps(x + i + 8)), _mm512_loadu_pd(y + i + 8))));
+    }
+    for (; i < n; i += 8) {
+        __mmask8 mask = n - i >= 8 ? 0xFF : tailMask(n - i);
+        __m512d diff = _mm512_sub_pd(loadF32Avx512(mask, x + i), _mm512_maskz_loadu_pd(mask, y + i));
+        acc0 = _mm512_max_pd(acc0, _mm512_abs_pd(diff));
+    }
+    return _mm512_reduce_max_pd(_mm512_max_pd(acc0, acc1));
+}
+
+const Table avx512Table = {
+    kernels::ISA::AVX512,
+    sumAbsAvx512, sumSquaresAvx512, maxAbsAvx512, dotAvx512,
+    distFirstAvx512, distSecondSquaredAvx512, distChebyshevAvx512,
+    isFiniteAvx512, incAvx512, decAvx512, scaleAvx512,
+    addAvx512, subAvx512, axpyAvx512, lerpAvx512,
+    distFirstF32Avx512, distSecondSquaredF32Avx512, distChebyshevF32Avx512,
+};
+
+#endif
+
+Table const* tableOf(kernels::ISA isa) {
+    switch (isa) {
+    case kernels::ISA::SCALAR:
+        return &scalarTable;
+#ifdef KERNELS_X86
+    case kernels::ISA::SSE2:
+        return &sse2Table;
+    case kernels::ISA::AVX2:
+        return &avx2Table;
+    case kernels::ISA::AVX512:
+        return &avx512Table;
+#endif
+    default:
+        return nullptr;
+    }
+}
+
+/*
+* setIsa() may run while other threads compute distances, a table is immutable, so only the pointer needs to be atomic
+*/
+std::atomic<Table const*>& activeTable() {
+    static std::atomic<Table const*> table(tableOf(kernels::detectIsa()));
+    return table;
+}
+
+Table const* active() {
+    return activeTable().load(std::memory_order_relaxed);
+}
+
+// coordinates summed between comparisons with the bound, small enough to stop early, large enough to keep the kernels busy
+constexpr size_t boundBlock = 64;
+
+/*
+* Partial sums of all three norms only grow, so the first block reaching the bound decides
+* SECOND sums squares, its root is compared to keep the bound check exact
+*/
+template <typename Row>
+double boundedDistance(double (*block)(Row const* x, double const* y, size_t n), IVector::NORM n,
+    Row const* row, double const* pat, size_t dim, double bound) {
+    double res = 0;
+    for (size_t i = 0; i < dim; i += boundBlock) {
+        double part = block(row + i, pat + i, std::min(boundBlock, dim - i));
+        res = n == IVector::NORM::CHEBYSHEV ? fmax(res, part) : res + part;
+        if ((n == IVector::NORM::SECOND ? sqrt(res) : res) >= bound) {
+            break;
+        }
+    }
+    return n == IVector::NORM::SECOND ? sqrt(res) : res;
+}
+
+}
+
+kernels::ISA kernels::detectIsa() {
+#ifdef KERNELS_X86
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx512f")) {
+        return ISA::AVX512;
+    }
+    if (__builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma")) {
+        return ISA::AVX2;
+    }
+    if (__builtin_cpu_supports("sse2")) {
+        return ISA::SSE2;
+    }
+#endif
+    return ISA::SCALAR;
+}
+
+kernels::ISA kernels::getIsa() {
+    return active()->isa;
+}
+
+RC kernels::setIsa(ISA isa) {
+    Table const* table = tableOf(isa);
+    if (!table || isa > detectIsa()) {
+        return RC::INVALID_ARGUMENT;
+    }
+    activeTable().store(table, std::memory_order_relaxed);
+    return RC::SUCCESS;
+}
+
+double kernels::norm(double const* data, size_t dim, IVector::NORM n) {
+    switch (n) {
+    case IVector::NORM::FIRST:
+        return active()->sumAbs(data, dim);
+    case IVector::NORM::SECOND:
+        return sqrt(active()->sumSquares(data, dim));
+    case IVector::NORM::CHEBYSHEV:
+        return active()->maxAbs(data, dim);
+    default:
+        return NAN;
+    }
+}
+
+double kernels::distance(double const* op1, double const* op2, size_t dim, IVector::NORM n) {
+    switch (n) {
+    case IVector::NORM::FIRST:
+        return active()->distFirst(op1, op2, dim);
+    case IVector::NORM::SECOND:
+        return sqrt(active()->distSecondSquared(op1, op2, dim));
+    case IVector::NORM::CHEBYSHEV:
+        return active()->distChebyshev(op1, op2, dim);
+    default:
+        return NAN;
+    }
+}
+
+double kernels::distance(float const* row, double const* pat, size_t dim, IVector::NORM n) {
+    switch (n) {
+    case IVector::NORM::FIRST:
+        return active()->distFirstF32(row, pat, dim);
+    case IVector::NORM::SECOND:
+        return sqrt(active()->distSecondSquaredF32(row, pat, dim));
+    case IVector::NORM::CHEBYSHEV:
+        return active()->distChebyshevF32(row, pat, dim);
+    default:
+        return NAN;
+    }
+}
+
+double kernels::distance(double const* op1, double const* op2, size_t dim, IVector::NORM n, double bound) {
+    switch (n) {
+    case IVector::NORM::FIRST:
+        return boundedDistance(active()->distFirst, n, op1, op2, dim, bound);
+    case IVector::NORM::SECOND:
+        return boundedDistance(active()->distSecondSquared, n, op1, op2, dim, bound);
+    case IVector::NORM::CHEBYSHEV:
+        return boundedDistance(active()->distChebyshev, n, op1, op2, dim, bound);
+    default:
+        return NAN;
+    }
+}
+
+double kernels::distance(float const* row, double const* pat, size_t dim, IVector::NORM n, double bound) {
+    switch (n) {
+    case IVector::NORM::FIRST:
+        return boundedDistance(active()->distFirstF32, n, row, pat, dim, bound);
+    case IVector::NORM::SECOND:
+        return boundedDistance(active()->distSecondSquaredF32, n, row, pat, dim, bound);
+    case IVector::NORM::CHEBYSHEV:
+        return boundedDistance(active()->distChebyshevF32, n, row, pat, dim, bound);
+    default:
+        return NAN;
+    }
+}
+
+void kernels::distances(double const* pat, double const* rows, size_t count, size_t dim, IVector::NORM n, double* out) {
+    Table const* table = active();
+    switch (n) {
+    case IVector::NORM::FIRST:
+        for (size_t i = 0; i < count; i++) {
+            out[i] = table->distFirst(rows + i * dim, pat, dim);
+        }
+        break;
+    case IVector::NORM::SECOND:
+        for (size_t i = 0; i < count; i++) {
+            out[i] = table->distSecondSquared(rows + i * dim, pat, dim);
+        }
+        for (size_t i = 0; i < count; i++) {
+            out[i] = sqrt(out[i]);
+        }
+        break;
+    case IVector::NORM::CHEBYSHEV:
+        for (size_t i = 0; i < count; i++) {
+            out[i] = table->distChebyshev(rows + i * dim, pat, dim);
+        }
+        break;
+    default:
+        for (size_t i = 0; i < count; i++) {
+            out[i] = NAN;
+        }
+    }
+}
+
+void kernels::distances(double const* pat, float const* rows, size_t count, size_t dim, IVector::NORM n, double* out) {
+    Table const* table = active();
+    switch (n) {
+    case IVector::NORM::FIRST:
+        for (size_t i = 0; i < count; i++) {
+            out[i] = table->distFirstF32(rows + i * dim, pat, dim);
+        }
+        break;
+    case IVector::NORM::SECOND:
+        for (size_t i = 0; i < count; i++) {
+            out[i] = table->distSecondSquaredF32(rows + i * dim, pat, dim);
+        }
+        for (size_t i = 0; i < count; i++) {
+            out[i] = sqrt(out[i]);
+        }
+        break;
+    case IVector::NORM::CHEBYSHEV:
+        for (size_t i = 0; i < count; i++) {
+            out[i] = table->distChebyshevF32(rows + i * dim, pat, dim);
+        }
+        break;
+    default:
+        for (size_t i = 0; i < count; i++) {
+            out[i] = NAN;
+        }
+    }
+}
+
+double kernels::dot(double const* op1, double const* op2, size_t dim) {
+    return active()->dot(op1, op2, dim);
+}
+
+double kernels::maxAbs(double const* data, size_t dim) {
+    return active()->maxAbs(data, dim);
+}
+
+bool kernels::isFinite(double const* data, size_t dim) {
+    return active()->isFinite(data, dim);
+}
+
+void kernels::inc(double* data, double const* op, size_t dim) {
+    active()->inc(data, op, dim);
+}
+
+void kernels::dec(double* data, double const* op, size_t dim) {
+    active()->dec(data, op, dim);
+}
+
+void kernels::scale(double* data, double multiplier, size_t dim) {
+    active()->scale(data, multiplier, dim);
+}
+
+void kernels::add(double* out, double const* op1, double const* op2, size_t dim) {
+    active()->add(out, op1, op2, dim);
+}
+
+void kernels::sub(double* out, double const* op1, double const* op2, size_t dim) {
+    active()->sub(out, op1, op2, dim);
+}
+
+void kernels::axpy(double* data, double alpha, double const* op, size_t dim) {
+    active()->axpy(data, alpha, op, dim);
+}
+
+void kernels::lerp(double* out, double const* op1, double const* op2, double t, size_t dim) {
+    active()->lerp(out, op1, op2, t, dim);
+}
+
+void kernels::widen(float const* src, double* dest, size_t dim) {
+    for (size_t i = 0; i < dim; i++) {
+        dest[i] = src[i];
+    }
+}
+
+void kernels::narrow(double const* src, float* dest, size_t dim) {
+    for (size_t i = 0; i < dim; i++) {
+        dest[i] = (float)src[i];
+    }
+}
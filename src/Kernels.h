@@ -0,0 +1,77 @@
+#pragma once
+#include <cstddef>
+#include "../include/IVector.h"
+
+/*
+* Vectorized loops over raw coordinate arrays shared by Vector and Set
+*
+* Implementation is picked once at the first call according to the running CPU:
+* AVX-512, AVX2 + FMA, SSE2 or plain scalar loops
+*/
+namespace kernels {
+
+enum class ISA {
+    SCALAR,
+    SSE2,
+    AVX2,
+    AVX512,
+    AMOUNT
+};
+
+/*
+* Best instruction set supported by both the build and the running CPU
+*/
+ISA detectIsa();
+ISA getIsa();
+
+/*
+* Forces kernels of a lower instruction set, e.g. to compare them with each other
+* Returns INVALID_ARGUMENT if `isa` isn't supported on this machine
+*/
+RC setIsa(ISA isa);
+
+double norm(double const* data, size_t dim, IVector::NORM n);
+double distance(double const* op1, double const* op2, size_t dim, IVector::NORM n);
+
+/*
+* Distances from `pat` to `count` rows stored contiguously, row-major, starting at `rows`
+*/
+void distances(double const* pat, double const* rows, size_t count, size_t dim, IVector::NORM n, double* out);
+
+/*
+* Same for float rows, coordinates are widened to double before subtracting
+*/
+double distance(float const* row, double const* pat, size_t dim, IVector::NORM n);
+void distances(double const* pat, float const* rows, size_t count, size_t dim, IVector::NORM n, double* out);
+/*
+* Distance if it is below `bound`, otherwise some value not below `bound`
+* Coordinates are summed block by block and the sum is abandoned once it reaches `bound`,
+* so rows far from the pattern cost only a few blocks however large the dimension
+*/
+double distance(double const* op1, double const* op2, size_t dim, IVector::NORM n, double bound);
+double distance(float const* row, double const* pat, size_t dim, IVector::NORM n, double bound);
+
+void widen(float const* src, double* dest, size_t dim);
+void narrow(double const* src, float* dest, size_t dim);
+
+double dot(double const* op1, double const* op2, size_t dim);
+double maxAbs(double const* data, size_t dim);
+
+/*
+* False if any coordinate is NaN or infinity
+*/
+bool isFinite(double const* data, size_t dim);
+
+void inc(double* data, double const* op, size_t dim);
+void dec(double* data, double const* op, size_t dim);
+void scale(double* data, double multiplier, size_t dim);
+
+/*
+* `out` may alias either operand
+*/
+void add(double* out, double const* op1, double const* op2, size_t dim);
+void sub(double* out, double const* op1, double const* op2, size_t dim);
+void axpy(double* data, double alpha, double const* op, size_t dim);
+void lerp(double* out, double const* op1, double const* op2, double t, size_t dim);
+
+}
@@ -0,0 +1,75 @@
+#include <functional>
+#include "LogFilter.h"
+
+constexpr std::chrono::seconds rateWindow(1);
+
+bool LogFilter::Site::operator==(const Site& other) const {
+    return code == other.code && srcfile == other.srcfile && line == other.line;
+}
+
+size_t LogFilter::SiteHash::operator()(const Site& site) const {
+    // call sites are told apart by the address of their __FILE__ literal and the line
+    size_t hash = std::hash<const void*>()(site.srcfile);
+    hash ^= (size_t)site.line * 0x9E3779B97F4A7C15ull + (hash << 6) + (hash >> 2);
+    hash ^= (size_t)site.code + (hash << 6) + (hash >> 2);
+    return hash;
+}
+
+LogFilter::LogFilter() {
+    _rateLimit = 0;
+    _coalesce = false;
+    _hasLast = false;
+    _last = { RC::UNKNOWN, nullptr, 0 };
+    _lastLevel = ILogger::Level::INFO;
+    _lastFunction = nullptr;
+    _repeated = 0;
+}
+
+void LogFilter::setRateLimit(size_t perSecond) {
+    _rateLimit = perSecond;
+}
+
+void LogFilter::setCoalescing(bool coalesce) {
+    _coalesce = coalesce;
+}
+
+bool LogFilter::admit(RC code, ILogger::Level level, const char* srcfile, const char* function, int line, Pending& pending) {
+    Site site = { code, srcfile, line };
+    if (_coalesce.load(std::memory_order_relaxed) && _hasLast && site == _last && level == _lastLevel && function == _lastFunction) {
+        _repeated++;
+        return false;
+    }
+
+    pending.suppressed = 0;
+    size_t limit = _rateLimit.load(std::memory_order_relaxed);
+    if (limit != 0) {
+        Clock::time_point now = Clock::now();
+        Bucket& bucket = _buckets.emplace(site, Bucket{ now, 0, 0 }).first->second;
+        if (now - bucket.window >= rateWindow) {
+            bucket.window = now;
+            bucket.written = 0;
+        }
+        if (bucket.written >= limit) {
+            // a dropped record ends the run of repeats, the next copy of the last one is written again
+            bucket.suppressed++;
+            _hasLast = false;
+            return false;
+        }
+        bucket.written++;
+        pending.suppressed = bucket.suppressed;
+        bucket.suppressed = 0;
+    }
+
+    pending.repeated = takeRepeated();
+    _hasLast = true;
+    _last = site;
+    _lastLevel = level;
+    _lastFunction = function;
+    return true;
+}
+
+size_t LogFilter::takeRepeated() {
+    size_t repeated = _repeated;
+    _repeated = 0;
+    return repeated;
+}
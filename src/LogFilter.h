@@ -0,0 +1,70 @@
+#pragma once
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <unordered_map>
+#include "../include/ILogger.h"
+
+/*
+* Rate limiting and repeat coalescing shared by logger implementations
+*
+* Not thread-safe: Logger calls it under its lock, AsyncLogger from the writer thread only.
+* Settings may be changed from any thread
+*/
+class LogFilter {
+public:
+    /*
+    * What has to be reported before a record admitted by admit()
+    */
+    struct Pending {
+        size_t repeated;   // Copies of the previous record coalesced away
+        size_t suppressed; // Records of this call site dropped by the rate limit since its last written record
+    };
+
+    LogFilter();
+
+    void setRateLimit(size_t perSecond);
+    void setCoalescing(bool coalesce);
+
+    /*
+    * False if the record is not to be written
+    */
+    bool admit(RC code, ILogger::Level level, const char* srcfile, const char* function, int line, Pending& pending);
+
+    /*
+    * Repeats of the last written record not reported yet, the count is reset
+    */
+    size_t takeRepeated();
+
+private:
+    using Clock = std::chrono::steady_clock;
+
+    struct Site {
+        RC code;
+        const char* srcfile;
+        int line;
+
+        bool operator==(const Site& other) const;
+    };
+
+    struct SiteHash {
+        size_t operator()(const Site& site) const;
+    };
+
+    struct Bucket {
+        Clock::time_point window;
+        size_t written;
+        size_t suppressed;
+    };
+
+    std::atomic<size_t> _rateLimit;
+    std::atomic<bool> _coalesce;
+
+    bool _hasLast;
+    Site _last;
+    ILogger::Level _lastLevel;
+    const char* _lastFunction;
+    size_t _repeated;
+
+    std::unordered_map<Site, Bucket, SiteHash> _buckets;
+};
@@ -1,3 +1,4 @@
+#include <cstring>
 #include "Logger.h"
 
 const char* Logger::getMessage(RC code) {
@@ -15,6 +16,7 @@ const char* Logger::getMessage(RC code) {
         "Unable to find vector",
         "Input/Output error",
         "Found intersecting memory while copying instance",
+        "Operation is not supported",
     };
     return msg[(int)code];
 }
@@ -52,20 +54,90 @@ ILogger* ILogger::createLogger(const char* const& filename, bool overwrite) {
     return new Logger(filename, overwrite);
 }
 
+void Logger::formatRepeated(size_t repeated, char* buffer, size_t size) {
+    buffer[0] = 0;
+    if (repeated > 0) {
+        snprintf(buffer, size, "Last message repeated %zu times\n", repeated);
+    }
+}
+
+void Logger::formatPending(const LogFilter::Pending& pending, char* buffer, size_t size) {
+    formatRepeated(pending.repeated, buffer, size);
+    if (pending.suppressed > 0) {
+        size_t used = strlen(buffer);
+        snprintf(buffer + used, size - used, "%zu messages of the next call site suppressed by rate limit\n", pending.suppressed);
+    }
+}
+
+void Logger::write(RC code, Level level) {
+    fprintf(stream, "%s: %s\n", getLevel(level), getMessage(code));
+}
+
+void Logger::writeRepeated(size_t repeated) {
+    char text[64];
+    formatRepeated(repeated, text, sizeof(text));
+    fputs(text, stream);
+}
+
 RC Logger::log(RC code, Level level, const char* const& srcfile, const char* const& function, int line) {
+    if (!isEnabled(level)) {
+        return RC::SUCCESS;
+    }
+    // one record is written under the lock, so records of different threads don't interleave
+    std::lock_guard<std::mutex> guard(lock);
+    LogFilter::Pending pending;
+    if (!filter.admit(code, level, srcfile, function, line, pending)) {
+        return RC::SUCCESS;
+    }
+    char text[160];
+    formatPending(pending, text, sizeof(text));
+    fputs(text, stream);
+    if (!srcfile) {
+        write(code, level);
+        return RC::SUCCESS;
+    }
     fprintf(stream, "#####\n");
-    log(code, level);
+    write(code, level);
     fprintf(stream, "File: %s\nLine: %i\nFunction: %s\n", srcfile, line, function);
     fprintf(stream, "#####\n");
     return RC::SUCCESS;
 }
 
 RC Logger::log(RC code, Level level) {
-    fprintf(stream, "%s: %s\n", getLevel(level), getMessage(code));
+    return log(code, level, nullptr, nullptr, 0);
+}
+
+RC Logger::logText(Level level, const char* const& text) {
+    if (!text) {
+        return RC::NULLPTR_ERROR;
+    }
+    if (!isEnabled(level)) {
+        return RC::SUCCESS;
+    }
+    std::lock_guard<std::mutex> guard(lock);
+    writeRepeated(filter.takeRepeated());
+    fprintf(stream, "%s: %s\n", getLevel(level), text);
+    return RC::SUCCESS;
+}
+
+RC Logger::flush() {
+    std::lock_guard<std::mutex> guard(lock);
+    writeRepeated(filter.takeRepeated());
+    return fflush(stream) == 0 ? RC::SUCCESS : RC::IO_ERROR;
+}
+
+RC Logger::setRateLimit(size_t perSecond) {
+    filter.setRateLimit(perSecond);
+    return RC::SUCCESS;
+}
+
+RC Logger::setCoalescing(bool coalesce) {
+    filter.setCoalescing(coalesce);
     return RC::SUCCESS;
 }
 
 Logger::~Logger() {
+    writeRepeated(filter.takeRepeated());
     fclose(stream);
 }
 
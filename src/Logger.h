@@ -1,15 +1,35 @@
 #pragma once
 #include <cstdio>
+#include <mutex>
 #include "../include/ILogger.h"
+#include "LogFilter.h"
 
 class Logger : public ILogger {
 private:
     FILE* stream;
-    const char* getMessage(RC code);
-    const char* getLevel(Level level);
+    std::mutex lock;
+    LogFilter filter;
+    void write(RC code, Level level);
+    void writeRepeated(size_t repeated);
 public:
+    /*
+    * Texts shared by all logger implementations
+    */
+    static const char* getMessage(RC code);
+    static const char* getLevel(Level level);
+
+    /*
+    * Notes written in place of records dropped by the filter, empty if nothing was dropped
+    */
+    static void formatPending(const LogFilter::Pending& pending, char* buffer, size_t size);
+    static void formatRepeated(size_t repeated, char* buffer, size_t size);
+
     Logger(const char* const& filename, bool overwrite = true);
     virtual RC log(RC code, Level level, const char* const& srcfile, const char* const& function, int line) override;
     virtual RC log(RC code, Level level) override;
+    virtual RC logText(Level level, const char* const& text) override;
+    virtual RC flush() override;
+    virtual RC setRateLimit(size_t perSecond) override;
+    virtual RC setCoalescing(bool coalesce) override;
     ~Logger();
 };
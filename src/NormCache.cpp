@@ -0,0 +1,93 @@
+#include <cmath>
+#include "NormCache.h"
+
+// covers rounding of both norms for dimensions far beyond practical ones
+constexpr double pruneSlack = 1e-12;
+
+NormCache::NormCache() {
+    for (bool& enabled : _enabled) {
+        enabled = false;
+    }
+}
+
+bool NormCache::isEnabled(IVector::NORM n) const {
+    return _enabled[(size_t)n];
+}
+
+double const* NormCache::get(IVector::NORM n) const {
+    return _enabled[(size_t)n] ? _norms[(size_t)n].data() : nullptr;
+}
+
+void NormCache::enable(IVector::NORM n, Rows const& rows, size_t size) {
+    std::vector<double>& norms = _norms[(size_t)n];
+    std::vector<double> buffer(rows.getDim());
+    norms.resize(size);
+    for (size_t i = 0; i < size; i++) {
+        norms[i] = kernels::norm(rows.read(i, buffer.data()), rows.getDim(), n);
+    }
+    _enabled[(size_t)n] = true;
+}
+
+void NormCache::assign(IVector::NORM n, double const* norms, size_t size) {
+    _norms[(size_t)n].assign(norms, norms + size);
+    _enabled[(size_t)n] = true;
+}
+
+void NormCache::append(Rows const& rows, size_t row) {
+    std::vector<double> buffer;
+    double const* data = nullptr;
+    for (size_t kind = 0; kind < kinds; kind++) {
+        if (!_enabled[kind]) {
+            continue;
+        }
+        if (!data) {
+            buffer.resize(rows.getDim());
+            data = rows.read(row, buffer.data());
+        }
+        _norms[kind].resize(row + 1);
+        _norms[kind][row] = kernels::norm(data, rows.getDim(), (IVector::NORM)kind);
+    }
+}
+
+void NormCache::move(size_t from, size_t to) {
+    for (size_t kind = 0; kind < kinds; kind++) {
+        if (_enabled[kind]) {
+            _norms[kind][to] = _norms[kind][from];
+        }
+    }
+}
+
+void NormCache::erase(size_t row) {
+    for (size_t kind = 0; kind < kinds; kind++) {
+        if (_enabled[kind]) {
+            _norms[kind].erase(_norms[kind].begin() + row);
+        }
+    }
+}
+
+void NormCache::resize(size_t size) {
+    for (size_t kind = 0; kind < kinds; kind++) {
+        if (_enabled[kind]) {
+            _norms[kind].resize(size);
+        }
+    }
+}
+
+void NormCache::shrinkToFit() {
+    for (std::vector<double>& norms : _norms) {
+        norms.shrink_to_fit();
+    }
+}
+
+size_t NormCache::sizeAllocated() const {
+    size_t size = 0;
+    for (const std::vector<double>& norms : _norms) {
+        size += norms.capacity() * sizeof(double);
+    }
+    return size;
+}
+
+bool NormCache::prunes(double rowNorm, double patNorm, double tol) {
+    // NaN norms or tolerance never prune, the exact check decides
+    return std::fabs(rowNorm - patNorm) - tol > pruneSlack * (rowNorm + patNorm);
+}
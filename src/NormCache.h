@@ -0,0 +1,60 @@
+#pragma once
+#include <cstddef>
+#include <vector>
+#include "../include/IVector.h"
+#include "Rows.h"
+
+/*
+* Norms of the rows of a Set, kept per NORM kind so that a pattern can be rejected without reading the row
+*
+* |‖row‖ - ‖pat‖| <= ‖row - pat‖ for every supported norm, so rows whose norm differs from the pattern's by tol
+* or more can't match. A kind is cached from the first insert() using it on, and follows the rows afterwards
+*/
+class NormCache {
+public:
+    NormCache();
+
+    bool isEnabled(IVector::NORM n) const;
+
+    /*
+    * Cached norms of all physical rows, nullptr if the kind isn't cached
+    */
+    double const* get(IVector::NORM n) const;
+
+    /*
+    * Starts caching `n` for the first `size` rows
+    */
+    void enable(IVector::NORM n, Rows const& rows, size_t size);
+
+    /*
+    * Starts caching `n` with `size` norms computed earlier, as stored by ISet::save()
+    */
+    void assign(IVector::NORM n, double const* norms, size_t size);
+
+    /*
+    * Row `row` has been appended to storage
+    */
+    void append(Rows const& rows, size_t row);
+
+    /*
+    * Mirror row moves in storage
+    */
+    void move(size_t from, size_t to);
+    void erase(size_t row);
+    void resize(size_t size);
+
+    void shrinkToFit();
+    size_t sizeAllocated() const;
+
+    /*
+    * True if a row of norm `rowNorm` is surely at least `tol` away from a pattern of norm `patNorm`
+    * Norms are rounded, so a small relative slack keeps borderline rows for the exact check
+    */
+    static bool prunes(double rowNorm, double patNorm, double tol);
+
+private:
+    static constexpr size_t kinds = (size_t)IVector::NORM::AMOUNT;
+
+    std::vector<double> _norms[kinds];
+    bool _enabled[kinds];
+};
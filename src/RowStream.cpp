@@ -0,0 +1,45 @@
+#include <algorithm>
+#include <cstdio>
+#include "RowStream.h"
+
+constexpr size_t chunkBytes = 1 << 20;
+
+size_t rowstream::chunkRows(size_t dim) {
+    return std::max<size_t>(1, chunkBytes / (dim * sizeof(double)));
+}
+
+RC rowstream::insertFile(ISet* set, const char* path, size_t dim, IVector::NORM n, double tol) {
+#ifndef FAST_MATH
+    if (!path) {
+        SendWarning(set->getLogger(), RC::NULLPTR_ERROR);
+        return RC::NULLPTR_ERROR;
+    }
+    if (dim == 0) {
+        SendWarning(set->getLogger(), RC::INVALID_ARGUMENT);
+        return RC::INVALID_ARGUMENT;
+    }
+#endif
+    FILE* file = fopen(path, "rb");
+    if (!file) {
+        SendWarning(set->getLogger(), RC::FILE_NOT_FOUND);
+        return RC::FILE_NOT_FOUND;
+    }
+    size_t rowBytes = dim * sizeof(double);
+    bool truncated = false;
+    RC code = set->insertStream([&](double* rows, size_t capacity) -> size_t {
+        if (truncated) {
+            return 0;
+        }
+        size_t bytes = fread(rows, 1, capacity * rowBytes, file);
+        // a regular file is read in full chunks until its end, a partial row can only be its tail
+        truncated = bytes % rowBytes != 0;
+        return bytes / rowBytes;
+    }, dim, n, tol);
+    bool failed = ferror(file) != 0;
+    fclose(file);
+    if (code == RC::SUCCESS && (failed || truncated)) {
+        SendWarning(set->getLogger(), RC::IO_ERROR);
+        return RC::IO_ERROR;
+    }
+    return code;
+}
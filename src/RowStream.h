@@ -0,0 +1,21 @@
+#pragma once
+#include <cstddef>
+#include "../include/ISet.h"
+
+/*
+* Streamed insertion shared by ISet implementations, see ISet::insertStream() and ISet::insertFile()
+*/
+namespace rowstream {
+
+/*
+* Number of `dim`-dimensional rows insertStream() reads at a time, about a megabyte of them
+*/
+size_t chunkRows(size_t dim);
+
+/*
+* insertFile() of `set`: the file is read once, in chunks of chunkRows(), and fed to set->insertStream()
+* A trailing partial row or a read failure gives IO_ERROR, rows inserted before it are kept
+*/
+RC insertFile(ISet* set, const char* path, size_t dim, IVector::NORM n, double tol);
+
+}
@@ -0,0 +1,67 @@
+#pragma once
+#include <cstddef>
+#include "../include/ISet.h"
+#include "Kernels.h"
+
+/*
+* Row-major coordinate storage of a Set holding doubles or floats, depending on the set precision
+* Every read yields doubles, floats are widened on the fly
+*/
+class Rows {
+public:
+    Rows(void const* data, size_t dim, ISet::PRECISION precision) : _data(data), _dim(dim), _precision(precision) {}
+
+    size_t getDim() const {
+        return _dim;
+    }
+
+    bool isFloat() const {
+        return _precision == ISet::PRECISION::FLOAT32;
+    }
+
+    double get(size_t row, size_t axis) const {
+        size_t i = row * _dim + axis;
+        return isFloat() ? ((float const*)_data)[i] : ((double const*)_data)[i];
+    }
+
+    /*
+    * Coordinates of `row`, widened into `buffer` of getDim() doubles unless they are stored as doubles
+    */
+    double const* read(size_t row, double* buffer) const {
+        if (!isFloat()) {
+            return (double const*)_data + row * _dim;
+        }
+        kernels::widen((float const*)_data + row * _dim, buffer, _dim);
+        return buffer;
+    }
+
+    double distance(size_t row, double const* pat, IVector::NORM n) const {
+        if (isFloat()) {
+            return kernels::distance((float const*)_data + row * _dim, pat, _dim, n);
+        }
+        return kernels::distance((double const*)_data + row * _dim, pat, _dim, n);
+    }
+
+    /*
+    * Exact below `bound`, see kernels::distance()
+    */
+    double distance(size_t row, double const* pat, IVector::NORM n, double bound) const {
+        if (isFloat()) {
+            return kernels::distance((float const*)_data + row * _dim, pat, _dim, n, bound);
+        }
+        return kernels::distance((double const*)_data + row * _dim, pat, _dim, n, bound);
+    }
+
+    void distances(size_t first, size_t count, double const* pat, IVector::NORM n, double* out) const {
+        if (isFloat()) {
+            kernels::distances(pat, (float const*)_data + first * _dim, count, _dim, n, out);
+        } else {
+            kernels::distances(pat, (double const*)_data + first * _dim, count, _dim, n, out);
+        }
+    }
+
+private:
+    void const* _data;
+    size_t _dim;
+    ISet::PRECISION _precision;
+};
@@ -1,26 +1,110 @@
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
 #include <cstring>
 #include <cmath>
+#include <cfloat>
+#include <cstdio>
+#include <new>
+#include <queue>
 #include "Set.h"
+#include "ConcurrentSet.h"
+#include "Kernels.h"
+#include "RowStream.h"
+
+#ifdef __unix__
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
 
 constexpr size_t basicSize = 100;
-constexpr size_t maxEnlarger = 1000;
+constexpr size_t dataAlignment = 64;
+constexpr double defaultGrowthFactor = 2;
+constexpr size_t scanBlock = 256;
+constexpr size_t parallelGrain = 2048;
+constexpr size_t tileBytes = 32 * 1024;
+constexpr size_t maxTileRows = 256;
+// squared L2 distances below this share of ||a||^2 + ||b||^2 lose too many digits to cancellation
+constexpr double cancellationBound = 1e-6;
 
-ILogger* Set::_logger = nullptr;
+std::atomic<ILogger*> Set::_logger(nullptr);
+static thread_local ILogger* threadLogger = nullptr;
+std::shared_ptr<ThreadPool> Set::_pool;
 
 RC Set::setLogger(ILogger* const logger) {
-    _logger = logger;
+    _logger.store(logger, std::memory_order_relaxed);
     return RC::SUCCESS;    
 }
 
+RC Set::attachLogger(ILogger* logger) {
+    _instanceLogger = logger;
+    return RC::SUCCESS;
+}
+
+ILogger* Set::getLogger() const {
+    if (_instanceLogger) {
+        return _instanceLogger;
+    }
+    return threadLogger ? threadLogger : _logger.load(std::memory_order_relaxed);
+}
+
+RC Set::setThreadCount(size_t threads) {
+    std::shared_ptr<ThreadPool> pool = threads == 1 ? nullptr : std::make_shared<ThreadPool>(threads);
+    std::atomic_store(&_pool, pool);
+    return RC::SUCCESS;
+}
+
+void Set::forChunks(size_t count, const ThreadPool::Body& body) {
+    forChunks(count, parallelGrain, body);
+}
+
+void Set::forChunks(size_t count, size_t grain, const ThreadPool::Body& body) {
+    std::shared_ptr<ThreadPool> pool = std::atomic_load(&_pool);
+    if (pool) {
+        pool->parallelFor(count, grain, body);
+        return;
+    }
+    for (size_t begin = 0; begin < count; begin += grain) {
+        body(begin, std::min(begin + grain, count));
+    }
+}
+
 inline size_t Set::vecDataSize() const {
-    return _dim * sizeof(double);
+    return _dim * (_precision == PRECISION::FLOAT32 ? sizeof(float) : sizeof(double));
 }
 
-Set::Set() {
+inline char* Set::rowAt(size_t row) const {
+    return _data + row * vecDataSize();
+}
+
+inline Rows Set::rows() const {
+    return Rows(_data, _dim, _precision);
+}
+
+void Set::writeRow(size_t row, double const* src) {
+    if (_precision == PRECISION::FLOAT32) {
+        kernels::narrow(src, (float*)rowAt(row), _dim);
+    } else {
+        memcpy(rowAt(row), src, vecDataSize());
+    }
+}
+
+Set::Set(PRECISION precision) {
+    _precision = precision;
     _size = 0;
     _dim = 0;
     _allocated = 0;
+    _reserved = 0;
+    _growthFactor = defaultGrowthFactor;
     _data = nullptr;
+    _mapping = nullptr;
+    _mappingSize = 0;
+    _indexType = INDEX::KD_TREE;
+    _index = nullptr;
+    _removeMode = REMOVE_MODE::SHIFT;
+    _instanceLogger = nullptr;
 }
 
 size_t Set::getDim() const {
@@ -28,18 +112,29 @@ size_t Set::getDim() const {
 }
 
 size_t Set::getSize() const {
-    return _size;
+    return _size - _tombstones.count();
+}
+
+ISet::PRECISION Set::getPrecision() const {
+    return _precision;
 }
 
 RC Set::get(size_t index, IVector const*& val) const {
 #ifndef FAST_MATH
-    if (index >= _size) {
+    if (index >= getSize()) {
+        SendWarning(getLogger(), RC::INDEX_OUT_OF_BOUND);
         return RC::INDEX_OUT_OF_BOUND;
     }
 #endif
-    IVector* vector = IVector::createVector(_dim, _data + index * _dim);
+    return getRow(_tombstones.physical(index), val);
+}
+
+RC Set::getRow(size_t row, IVector const*& val) const {
+    std::vector<double> buffer(_precision == PRECISION::FLOAT32 ? _dim : 0);
+    IVector* vector = IVector::createVector(_dim, rows().read(row, buffer.data()));
 #ifndef FAST_MATH
     if (!vector) {
+        SendWarning(getLogger(), RC::ALLOCATION_ERROR);
         return RC::ALLOCATION_ERROR;
     }
 #endif
@@ -47,168 +142,1289 @@ RC Set::get(size_t index, IVector const*& val) const {
     return RC::SUCCESS;
 }
 
-RC Set::findFirst(IVector const * const& pat, IVector::NORM n, double tol, IVector *& val, size_t& index) const {
+RC Set::findFirst(IVector const * const& pat, IVector::NORM n, double tol, size_t& row) const {
 #ifndef FAST_MATH
-    if (val->getDim() != _dim || pat->getDim() != _dim) {
+    if (pat->getDim() != _dim) {
+        SendWarning(getLogger(), RC::MISMATCHING_DIMENSIONS);
         return RC::MISMATCHING_DIMENSIONS;
     }
 #endif
+    return findFirst(pat->getData(), n, tol, row);
+}
+
+RC Set::findFirst(double const* patData, IVector::NORM n, double tol, size_t& row) const {
     if (_size == 0) {
         return RC::VECTOR_NOT_FOUND;
     }
-    for (int i = 0; i < _size; i++) {
-        // will be optimized after IVector interface change
-        for (int j = 0; j < _dim; j++) {
-            val->setCord(j, *(_data + i * _dim + j));
+    Rows stored = rows();
+    double const* norms = n < IVector::NORM::AMOUNT ? _norms.get(n) : nullptr;
+    double patNorm = norms ? kernels::norm(patData, _dim, n) : 0;
+    if (!_index) {
+        std::atomic<size_t> first(_size);
+        forChunks(_size, [&](size_t begin, size_t end) {
+            size_t checked = 0, pruned = 0;
+            for (size_t i = begin; i < end && i < first; i++) {
+                checked++;
+                if (norms && NormCache::prunes(norms[i], patNorm, tol)) {
+                    pruned++;
+                    continue;
+                }
+                if (stored.distance(i, patData, n, tol) < tol && !_tombstones.isDead(i)) {
+                    size_t cur = first;
+                    while (i < cur && !first.compare_exchange_weak(cur, i));
+                    break;
+                }
+            }
+            COUNT_STAT(_counters, CANDIDATES, checked);
+            COUNT_STAT(_counters, PRUNED, pruned);
+            COUNT_STAT(_counters, DISTANCES, checked - pruned);
+        });
+        if (first == _size) {
+            return RC::VECTOR_NOT_FOUND;
+        }
+        row = first;
+        return RC::SUCCESS;
+    }
+    // index reports candidates in arbitrary order, the smallest matching row keeps findFirst() semantics
+    size_t found = _size;
+    size_t checked = 0, pruned = 0;
+    _index->query(stored, patData, tol, [&](size_t candidate) {
+        if (candidate >= found) {
+            return true;
         }
-        val->dec(pat);
-        if (val->norm(n) < tol) {
-            index = i;
-            return RC::SUCCESS;
+        checked++;
+        if (norms && NormCache::prunes(norms[candidate], patNorm, tol)) {
+            pruned++;
+        } else if (stored.distance(candidate, patData, n, tol) < tol) {
+            found = candidate;
         }
+        return true;
+    });
+    COUNT_STAT(_counters, CANDIDATES, checked);
+    COUNT_STAT(_counters, PRUNED, pruned);
+    COUNT_STAT(_counters, DISTANCES, checked - pruned);
+    if (found == _size) {
+        return RC::VECTOR_NOT_FOUND;
     }
-    return RC::VECTOR_NOT_FOUND;
+    row = found;
+    return RC::SUCCESS;
 }
 
 RC Set::findFirst(IVector const * const& pat, IVector::NORM n, double tol, IVector const *& val) const {
-    size_t index = 0;
-    if (_size == 0) {
-        return RC::VECTOR_NOT_FOUND;
+    dumpStats();
+    size_t row = 0;
+    RC code = findFirst(pat, n, tol, row);
+    if (code != RC::SUCCESS) {
+        return code;
+    }
+    return getRow(row, val);
+}
+
+RC Set::getView(size_t index, IVectorView& view) const {
+    if (_precision != PRECISION::FLOAT64) {
+        return RC::NOT_SUPPORTED;
+    }
+#ifndef FAST_MATH
+    if (index >= getSize()) {
+        SendWarning(getLogger(), RC::INDEX_OUT_OF_BOUND);
+        return RC::INDEX_OUT_OF_BOUND;
     }
-    IVector* vec = IVector::createVector(_dim, _data);
-    RC code = findFirst(pat, n, tol, vec, index);
+#endif
+    view = IVectorView(_dim, (double const*)rowAt(_tombstones.physical(index)));
+    return RC::SUCCESS;
+}
+
+RC Set::findFirstView(IVector const * const& pat, IVector::NORM n, double tol, IVectorView& view) const {
+    dumpStats();
+    if (_precision != PRECISION::FLOAT64) {
+        return RC::NOT_SUPPORTED;
+    }
+    size_t row = 0;
+    RC code = findFirst(pat, n, tol, row);
     if (code != RC::SUCCESS) {
-        delete vec;
         return code;
     }
-    val = vec;
+    view = IVectorView(_dim, (double const*)rowAt(row));
     return RC::SUCCESS;
 }
 
-bool Set::allocate() {
-    double* newData = new double[fmin(2 * _allocated, maxEnlarger) * vecDataSize()];
-    if (!newData) {
-        return false;
+RC Set::findAll(IVector const * const& pat, IVector::NORM n, double tol, std::vector<size_t>& indices) const {
+    dumpStats();
+    indices.clear();
+#ifndef FAST_MATH
+    if (pat->getDim() != _dim) {
+        SendWarning(getLogger(), RC::MISMATCHING_DIMENSIONS);
+        return RC::MISMATCHING_DIMENSIONS;
+    }
+    if (n >= IVector::NORM::AMOUNT) {
+        SendWarning(getLogger(), RC::INVALID_ARGUMENT);
+        return RC::INVALID_ARGUMENT;
+    }
+#endif
+    double const* patData = pat->getData();
+    Rows stored = rows();
+    if (_index) {
+        size_t checked = 0;
+        _index->query(stored, patData, tol, [&](size_t row) {
+            checked++;
+            if (stored.distance(row, patData, n, tol) < tol) {
+                indices.push_back(row);
+            }
+            return true;
+        });
+        COUNT_STAT(_counters, DISTANCES, checked);
+        std::sort(indices.begin(), indices.end());
+    } else {
+        // every chunk collects its own matches, concatenating them in chunk order keeps indices ascending
+        std::vector<std::vector<size_t>> found((_size + parallelGrain - 1) / parallelGrain);
+        forChunks(_size, [&](size_t begin, size_t end) {
+            std::vector<size_t>& chunk = found[begin / parallelGrain];
+            COUNT_STAT(_counters, DISTANCES, end - begin);
+            double dists[scanBlock];
+            for (size_t block = begin; block < end; block += scanBlock) {
+                size_t count = std::min(scanBlock, end - block);
+                stored.distances(block, count, patData, n, dists);
+                for (size_t i = 0; i < count; i++) {
+                    if (dists[i] < tol && !_tombstones.isDead(block + i)) {
+                        chunk.push_back(block + i);
+                    }
+                }
+            }
+        });
+        for (const std::vector<size_t>& chunk : found) {
+            indices.insert(indices.end(), chunk.begin(), chunk.end());
+        }
+    }
+    if (_tombstones.count() != 0) {
+        for (size_t& index : indices) {
+            index = _tombstones.logical(index);
+        }
+    }
+    return indices.empty() ? RC::VECTOR_NOT_FOUND : RC::SUCCESS;
+}
+
+RC Set::findKNearest(IVector const * const& pat, IVector::NORM n, size_t k, std::vector<size_t>& indices, std::vector<double>& dists) const {
+    dumpStats();
+    indices.clear();
+    dists.clear();
+#ifndef FAST_MATH
+    if (pat->getDim() != _dim) {
+        SendWarning(getLogger(), RC::MISMATCHING_DIMENSIONS);
+        return RC::MISMATCHING_DIMENSIONS;
+    }
+    if (n >= IVector::NORM::AMOUNT || k == 0) {
+        SendWarning(getLogger(), RC::INVALID_ARGUMENT);
+        return RC::INVALID_ARGUMENT;
+    }
+#endif
+    if (getSize() == 0) {
+        return RC::VECTOR_NOT_FOUND;
+    }
+    // max-heaps of the k best (distance, index) pairs of every chunk, (distance, index) ordering is total,
+    // so merging them gives the same result as the serial scan
+    using Heap = std::priority_queue<std::pair<double, size_t>>;
+    auto offer = [k](Heap& heap, std::pair<double, size_t> candidate) {
+        if (heap.size() < k) {
+            heap.push(candidate);
+        } else if (candidate < heap.top()) {
+            heap.pop();
+            heap.push(candidate);
+        }
+    };
+    Rows stored = rows();
+    std::vector<Heap> heaps((_size + parallelGrain - 1) / parallelGrain);
+    forChunks(_size, [&](size_t begin, size_t end) {
+        Heap& heap = heaps[begin / parallelGrain];
+        COUNT_STAT(_counters, DISTANCES, end - begin);
+        double blockDists[scanBlock];
+        for (size_t block = begin; block < end; block += scanBlock) {
+            size_t count = std::min(scanBlock, end - block);
+            stored.distances(block, count, pat->getData(), n, blockDists);
+            for (size_t i = 0; i < count; i++) {
+                if (!std::isnan(blockDists[i]) && !_tombstones.isDead(block + i)) {
+                    offer(heap, { blockDists[i], block + i });
+                }
+            }
+        }
+    });
+    Heap best;
+    for (Heap& heap : heaps) {
+        for (; !heap.empty(); heap.pop()) {
+            offer(best, heap.top());
+        }
+    }
+    indices.resize(best.size());
+    dists.resize(best.size());
+    for (size_t i = best.size(); i > 0; i--) {
+        dists[i - 1] = best.top().first;
+        indices[i - 1] = _tombstones.logical(best.top().second);
+        best.pop();
+    }
+    return RC::SUCCESS;
+}
+
+bool Set::reallocate(size_t capacity) {
+    char* newData = nullptr;
+    if (capacity > 0) {
+        if (capacity > SIZE_MAX / vecDataSize()) {
+            return false;
+        }
+        newData = (char*)::operator new(capacity * vecDataSize(), std::align_val_t(dataAlignment), std::nothrow);
+        if (!newData) {
+            return false;
+        }
     }
     if (_data) {
-        memcpy(newData, _data, _allocated * vecDataSize());
-        delete _data;
+        if (_size > 0) {
+            memcpy(newData, _data, _size * vecDataSize());
+        }
+        releaseData();
+        COUNT_STAT(_counters, REALLOCATIONS, 1);
     }
-    _allocated = fmin(2 * _allocated, maxEnlarger);
+    _allocated = capacity;
     _data = newData;
     return true;
 }
 
+bool Set::grow(size_t required) {
+    if (required <= _allocated) {
+        return true;
+    }
+    double enlarged = ceil(_allocated * _growthFactor);
+    size_t capacity = enlarged < (double)SIZE_MAX ? (size_t)enlarged : SIZE_MAX;
+    return reallocate(std::max(std::max(capacity, required), basicSize));
+}
+
+bool Set::init(size_t dim) {
+    _dim = dim;
+    if (_dim == 0 || !grow(_reserved)) {
+        _dim = 0;
+        return false;
+    }
+    _index = SetIndex::createIndex(_indexType, _dim);
+    return true;
+}
+
+RC Set::reserve(size_t capacity) {
+    if (_dim == 0) {
+        _reserved = capacity;
+        return RC::SUCCESS;
+    }
+    if (capacity > _allocated && !reallocate(capacity)) {
+        SendWarning(getLogger(), RC::ALLOCATION_ERROR);
+        return RC::ALLOCATION_ERROR;
+    }
+    return RC::SUCCESS;
+}
+
+RC Set::shrinkToFit() {
+    _reserved = 0;
+    if (_dim == 0) {
+        return RC::SUCCESS;
+    }
+    RC code = compact();
+    if (code != RC::SUCCESS) {
+        return code;
+    }
+    if (_index) {
+        _index->shrinkToFit(rows());
+    }
+    _norms.shrinkToFit();
+    if (_size == _allocated) {
+        return RC::SUCCESS;
+    }
+    return reallocate(_size) ? RC::SUCCESS : RC::ALLOCATION_ERROR;
+}
+
+RC Set::setGrowthFactor(double factor) {
+#ifndef FAST_MATH
+    if (!(factor > 1) || std::isinf(factor)) {
+        SendWarning(getLogger(), RC::INVALID_ARGUMENT);
+        return RC::INVALID_ARGUMENT;
+    }
+#endif
+    _growthFactor = factor;
+    return RC::SUCCESS;
+}
+
+size_t Set::sizeAllocated() const {
+    return sizeof(Set) + _allocated * vecDataSize() + (_index ? _index->sizeAllocated() : 0) + _tombstones.sizeAllocated() +
+        _norms.sizeAllocated();
+}
+
+RC Set::getStats(Stats& stats) const {
+#ifdef COLLECT_STATS
+    stats.distances = (size_t)_counters.get(Counters::Counter::DISTANCES);
+    stats.candidates = (size_t)_counters.get(Counters::Counter::CANDIDATES);
+    stats.pruned = (size_t)_counters.get(Counters::Counter::PRUNED);
+    stats.reallocations = (size_t)_counters.get(Counters::Counter::REALLOCATIONS);
+    stats.bytesMoved = (size_t)_counters.get(Counters::Counter::BYTES_MOVED);
+    return RC::SUCCESS;
+#else
+    stats = {};
+    return RC::NOT_SUPPORTED;
+#endif
+}
+
+RC Set::resetStats() {
+#ifdef COLLECT_STATS
+    _counters.reset();
+    return RC::SUCCESS;
+#else
+    return RC::NOT_SUPPORTED;
+#endif
+}
+
+RC Set::setStatsDump(size_t milliseconds) {
+#ifdef COLLECT_STATS
+    _counters.setDumpPeriod(milliseconds);
+    return RC::SUCCESS;
+#else
+    (void)milliseconds;
+    return RC::NOT_SUPPORTED;
+#endif
+}
+
+void Set::dumpStats() const {
+#ifdef COLLECT_STATS
+    if (!_counters.takeDump()) {
+        return;
+    }
+    ILogger* logger = getLogger();
+    Stats stats;
+    if (!logger || getStats(stats) != RC::SUCCESS) {
+        return;
+    }
+    char text[192];
+    snprintf(text, sizeof(text), "Set stats: %zu distances, %zu candidates, %zu pruned, %zu reallocations, %zu bytes moved",
+        stats.distances, stats.candidates, stats.pruned, stats.reallocations, stats.bytesMoved);
+    logger->logText(ILogger::Level::INFO, text);
+#endif
+}
+
 RC Set::insert(IVector const *& val, IVector::NORM n, double tol) {
+    dumpStats();
+    if (_dim == 0 && !init(val->getDim())) {
+        SendWarning(getLogger(), RC::ALLOCATION_ERROR);
+        return RC::ALLOCATION_ERROR;
+    }
 #ifndef FAST_MATH
     if (val->getDim() != _dim) {
+        SendWarning(getLogger(), RC::MISMATCHING_DIMENSIONS);
         return RC::MISMATCHING_DIMENSIONS;
     }
 #endif
-    if (_allocated == 0) {
-        _allocated = basicSize / 2;
-        _dim = val->getDim();
-        allocate();
+    return insert(val->getData(), n, tol);
+}
+
+RC Set::insert(double const* row, IVector::NORM n, double tol) {
+#ifndef FAST_MATH
+    if (_precision == PRECISION::FLOAT32 && kernels::maxAbs(row, _dim) > FLT_MAX) {
+        SendWarning(getLogger(), RC::INFINITY_OVERFLOW);
+        return RC::INFINITY_OVERFLOW;
     }
-    if (_size == 0) {
-        memmove(_data, val->getData(), _dim * sizeof(double)); 
-        _size++;       
+#endif
+    if (n < IVector::NORM::AMOUNT && !_norms.isEnabled(n)) {
+        _norms.enable(n, rows(), _size);
+    }
+    size_t index = 0;
+    if (findFirst(row, n, tol, index) == RC::SUCCESS) {
         return RC::SUCCESS;
     }
-    if (_size == _allocated) {
-        allocate();
+    if (_size == _allocated && !grow(_size + 1)) {
+        SendWarning(getLogger(), RC::ALLOCATION_ERROR);
+        return RC::ALLOCATION_ERROR;
     }
-    IVector* curVec = IVector::createVector(_dim, _data);
-    size_t index = 0;
-    if (findFirst(val, n, tol, curVec, index) != RC::SUCCESS) {
-        memmove(_data + _size * _dim, val->getData(), _dim * sizeof(double));
+    writeRow(_size, row);
+    if (_index) {
+        _index->insert(rows(), _size, tol);
+    }
+    _norms.append(rows(), _size);
+    _tombstones.append();
+    _size++;
+    return RC::SUCCESS;
+}
+
+RC Set::beginBatch(size_t dim) {
+    if (dim == 0) {
+        SendWarning(getLogger(), RC::INVALID_ARGUMENT);
+        return RC::INVALID_ARGUMENT;
+    }
+    if (_dim == 0 && !init(dim)) {
+        SendWarning(getLogger(), RC::ALLOCATION_ERROR);
+        return RC::ALLOCATION_ERROR;
+    }
+#ifndef FAST_MATH
+    if (dim != _dim) {
+        SendWarning(getLogger(), RC::MISMATCHING_DIMENSIONS);
+        return RC::MISMATCHING_DIMENSIONS;
+    }
+#endif
+    return RC::SUCCESS;
+}
+
+RC Set::insertRows(double const* data, size_t count, IVector::NORM n, double tol, SetIndex* members) {
+#ifndef FAST_MATH
+    // vectors can't hold NaN or infinity, neither can rows inserted without them
+    for (size_t i = 0; i < count; i++) {
+        if (!kernels::isFinite(data + i * _dim, _dim)) {
+            SendWarning(getLogger(), RC::INVALID_ARGUMENT);
+            return RC::INVALID_ARGUMENT;
+        }
+    }
+    for (size_t i = 0; i < count && _precision == PRECISION::FLOAT32; i++) {
+        if (kernels::maxAbs(data + i * _dim, _dim) > FLT_MAX) {
+            SendWarning(getLogger(), RC::INFINITY_OVERFLOW);
+            return RC::INFINITY_OVERFLOW;
+        }
+    }
+#endif
+    // on one thread an index growing row by row answers lookups cheaper than one holding the whole batch,
+    // which only pays off when the lookups run in parallel or there is no index to grow
+    if (_index && !std::atomic_load(&_pool)) {
+        for (size_t i = 0; i < count; i++) {
+            RC code = insert(data + i * _dim, n, tol);
+            if (code != RC::SUCCESS) {
+                return code;
+            }
+        }
+        return RC::SUCCESS;
+    }
+    if (n < IVector::NORM::AMOUNT && !_norms.isEnabled(n)) {
+        _norms.enable(n, rows(), _size);
+    }
+    if (!grow(_size + count)) {
+        SendWarning(getLogger(), RC::ALLOCATION_ERROR);
+        return RC::ALLOCATION_ERROR;
+    }
+    // the whole batch is written and indexed past the end, insert() compares a vector with earlier rows as stored
+    size_t first = _size;
+    for (size_t i = 0; i < count; i++) {
+        writeRow(first + i, data + i * _dim);
+    }
+    SetIndex* index = members ? members : _index;
+    Rows stored = rows();
+    if (index) {
+        index->append(stored, first, first + count, tol);
+    }
+
+    // nothing is closer than a non-positive tol
+    std::vector<char> kept(count, 1);
+    if (tol > 0) {
+        auto matched = [&](size_t i, bool ordered) {
+            double const* vec = data + i * _dim;
+            bool found = false;
+            size_t checked = 0;
+            index->query(stored, vec, tol, [&](size_t row) {
+                bool earlier = row < first ? !_tombstones.isDead(row) : row < first + i && (!ordered || kept[row - first]);
+                if (earlier) {
+                    checked++;
+                    found = stored.distance(row, vec, n, tol) < tol;
+                }
+                return !found;
+            });
+            COUNT_STAT(_counters, DISTANCES, checked);
+            return found;
+        };
+        // a row close to no member and no earlier row of the batch is kept whatever happens to the others,
+        // which is most of them, so only the rest is resolved in order
+        std::vector<char> crowded(count, 0);
+        forChunks(count, [&](size_t begin, size_t end) {
+            for (size_t i = begin; i < end; i++) {
+                crowded[i] = matched(i, false);
+            }
+        });
+        for (size_t i = 0; i < count; i++) {
+            kept[i] = !crowded[i] || !matched(i, true);
+        }
+    }
+
+    // dropped rows leave the index while still in place, kept ones close the gaps
+    for (size_t i = 0; i < count && index; i++) {
+        if (!kept[i]) {
+            index->remove(stored, first + i);
+        }
+    }
+    for (size_t i = 0; i < count; i++) {
+        if (!kept[i]) {
+            continue;
+        }
+        if (_size != first + i) {
+            if (index) {
+                index->move(stored, first + i, _size);
+            }
+            memcpy(rowAt(_size), rowAt(first + i), vecDataSize());
+        }
+        _norms.append(stored, _size);
+        _tombstones.append();
         _size++;
     }
-    delete curVec;
     return RC::SUCCESS;
 }
 
+/*
+* Sets without an index look members up in a k-d tree built for the call, tombstoned rows are indexed but never matched
+*/
+RC Set::insertBatch(double const* data, size_t dim, size_t count, IVector::NORM n, double tol) {
+    dumpStats();
+#ifndef FAST_MATH
+    if (!data && count > 0) {
+        SendWarning(getLogger(), RC::NULLPTR_ERROR);
+        return RC::NULLPTR_ERROR;
+    }
+#endif
+    if (count == 0) {
+        return RC::SUCCESS;
+    }
+    RC code = beginBatch(dim);
+    if (code != RC::SUCCESS) {
+        return code;
+    }
+    SetIndex* members = nullptr;
+    if (!_index && tol > 0) {
+        members = new KdTreeIndex(_dim);
+        members->append(rows(), 0, _size, tol);
+    }
+    code = insertRows(data, count, n, tol, members);
+    delete members;
+    return code;
+}
+
+RC Set::insertStream(const RowReader& read, size_t dim, IVector::NORM n, double tol) {
+    dumpStats();
+#ifndef FAST_MATH
+    if (!read) {
+        SendWarning(getLogger(), RC::NULLPTR_ERROR);
+        return RC::NULLPTR_ERROR;
+    }
+#endif
+    RC code = beginBatch(dim);
+    if (code != RC::SUCCESS) {
+        return code;
+    }
+    size_t capacity = rowstream::chunkRows(_dim);
+    std::vector<double> chunk(capacity * _dim);
+    // one tree serves the whole stream, growing with every chunk
+    SetIndex* members = nullptr;
+    if (!_index && tol > 0) {
+        members = new KdTreeIndex(_dim);
+        members->append(rows(), 0, _size, tol);
+    }
+    while (code == RC::SUCCESS) {
+        size_t count = read(chunk.data(), capacity);
+        if (count == 0) {
+            break;
+        }
+        if (count > capacity) {
+            SendWarning(getLogger(), RC::INVALID_ARGUMENT);
+            code = RC::INVALID_ARGUMENT;
+            break;
+        }
+        code = insertRows(chunk.data(), count, n, tol, members);
+    }
+    delete members;
+    return code;
+}
+
+RC Set::insertFile(const char* const& path, size_t dim, IVector::NORM n, double tol) {
+    return rowstream::insertFile(this, path, dim, n, tol);
+}
+
 RC Set::remove(size_t index) {
+    dumpStats();
 #ifndef FAST_MATH
-    if (index >= _size) {
+    if (index >= getSize()) {
+        SendWarning(getLogger(), RC::INDEX_OUT_OF_BOUND);
         return RC::INDEX_OUT_OF_BOUND;
     }
 #endif
-    memcpy(_data + index * _dim, _data + (index + 1) * _dim, _allocated * vecDataSize() - vecDataSize() * (index + 1));
-    _size--;
+    removeRow(_tombstones.physical(index));
     return RC::SUCCESS;
 }
 
 RC Set::remove(IVector const * const& pat, IVector::NORM n, double tol) {
-    size_t index = 0;
+    dumpStats();
+    size_t row = 0;
+    RC code = findFirst(pat, n, tol, row);
+    if (code == RC::SUCCESS) {
+        removeRow(row);
+    }
+    return code;
+}
+
+void Set::removeRow(size_t row) {
+    if (_index) {
+        _index->remove(rows(), row);
+    }
+    switch (_removeMode) {
+    case REMOVE_MODE::SWAP_LAST:
+        if (row != _size - 1) {
+            if (_index) {
+                _index->move(rows(), _size - 1, row);
+            }
+            memcpy(rowAt(row), rowAt(_size - 1), vecDataSize());
+            COUNT_STAT(_counters, BYTES_MOVED, vecDataSize());
+            _norms.move(_size - 1, row);
+        }
+        _size--;
+        _norms.resize(_size);
+        break;
+    case REMOVE_MODE::TOMBSTONE:
+        _tombstones.kill(row, _size);
+        if (2 * _tombstones.count() > _size) {
+            compact();
+        }
+        break;
+    default:
+        if (_index) {
+            _index->shift(row);
+        }
+        memmove(rowAt(row), rowAt(row + 1), (_size - row - 1) * vecDataSize());
+        COUNT_STAT(_counters, BYTES_MOVED, (_size - row - 1) * vecDataSize());
+        _norms.erase(row);
+        _size--;
+        break;
+    }
+}
+
+RC Set::removeIf(const std::function<bool(double const* vec)>& predicate) {
+    Rows stored = rows();
+    std::vector<double> buffer(_dim);
+    size_t kept = 0, moved = 0;
+    for (size_t i = 0; i < _size; i++) {
+        if (_tombstones.isDead(i) || predicate(stored.read(i, buffer.data()))) {
+            continue;
+        }
+        if (kept != i) {
+            memcpy(rowAt(kept), rowAt(i), vecDataSize());
+            _norms.move(i, kept);
+            moved++;
+        }
+        kept++;
+    }
+    COUNT_STAT(_counters, BYTES_MOVED, moved * vecDataSize());
+    if (kept == _size) {
+        return RC::SUCCESS;
+    }
+    _size = kept;
+    _norms.resize(_size);
+    _tombstones.clear();
+    return rebuildIndex();
+}
+
+RC Set::compact() {
+    if (_tombstones.count() == 0) {
+        return RC::SUCCESS;
+    }
+    return removeIf([](double const*) { return false; });
+}
+
+RC Set::setRemoveMode(REMOVE_MODE mode) {
 #ifndef FAST_MATH
-    if (_size == 0) {
-        return RC::VECTOR_NOT_FOUND;
+    if (mode >= REMOVE_MODE::AMOUNT) {
+        SendWarning(getLogger(), RC::INVALID_ARGUMENT);
+        return RC::INVALID_ARGUMENT;
     }
 #endif
-    IVector* vec = IVector::createVector(_dim, _data);
+    _removeMode = mode;
+    return mode == REMOVE_MODE::TOMBSTONE ? RC::SUCCESS : compact();
+}
+
+ISet::REMOVE_MODE Set::getRemoveMode() const {
+    return _removeMode;
+}
+
+double const* Set::denseRows(std::vector<double>& buffer) const {
+    if (_precision == PRECISION::FLOAT64 && _tombstones.count() == 0) {
+        return (double const*)_data;
+    }
+    Rows stored = rows();
+    buffer.resize(getSize() * _dim);
+    size_t packed = 0;
+    for (size_t i = 0; i < _size; i++) {
+        if (!_tombstones.isDead(i)) {
+            double* dest = buffer.data() + packed * _dim;
+            double const* src = stored.read(i, dest);
+            if (src != dest) {
+                memcpy(dest, src, _dim * sizeof(double));
+            }
+            packed++;
+        }
+    }
+    return buffer.data();
+}
+
+RC Set::rebuildIndex() {
+    return _index ? _index->rebuild(rows(), _size) : RC::SUCCESS;
+}
+
+RC Set::setIndex(INDEX type) {
 #ifndef FAST_MATH
-    if (!vec) {
-        return RC::ALLOCATION_ERROR;
+    if (type >= INDEX::AMOUNT) {
+        SendWarning(getLogger(), RC::INVALID_ARGUMENT);
+        return RC::INVALID_ARGUMENT;
     }
 #endif
-    RC code = findFirst(pat, n, tol, vec, index);
-    delete vec;
-    if (code == RC::SUCCESS) {
-        remove(index);
+    _indexType = type;
+    if (_dim == 0) {
+        return RC::SUCCESS;
     }
-    return code;
+    delete _index;
+    _index = SetIndex::createIndex(type, _dim);
+    if (_tombstones.count() != 0) {
+        return compact();
+    }
+    return rebuildIndex();
+}
+
+ISet::INDEX Set::getIndex() const {
+    return _indexType;
+}
+
+void Set::releaseData() {
+    if (!_mapping) {
+        ::operator delete(_data, std::align_val_t(dataAlignment));
+        return;
+    }
+#ifdef __unix__
+    munmap(_mapping, _mappingSize);
+#endif
+    _mapping = nullptr;
+    _mappingSize = 0;
 }
 
 Set::~Set() {
-    delete _data;
+    delete _index;
+    releaseData();
+}
+
+RC Set::save(const char* const& path) const {
+    dumpStats();
+#ifndef FAST_MATH
+    if (!path) {
+        SendWarning(getLogger(), RC::NULLPTR_ERROR);
+        return RC::NULLPTR_ERROR;
+    }
+#endif
+    if (!setfile::isLittleEndian()) {
+        SendWarning(getLogger(), RC::NOT_SUPPORTED);
+        return RC::NOT_SUPPORTED;
+    }
+    size_t count = getSize();
+    bool dense = _tombstones.count() == 0;
+
+    setfile::Header header = {};
+    memcpy(header.magic, setfile::magic, sizeof(header.magic));
+    header.version = setfile::version;
+    header.headerSize = sizeof(header);
+    header.dim = _dim;
+    header.size = count;
+    header.precision = (uint8_t)_precision;
+    header.index = (uint8_t)_indexType;
+    header.dataOffset = setfile::align(sizeof(header));
+    header.normsOffset = setfile::align(header.dataOffset + (uint64_t)count * vecDataSize());
+    uint64_t end = header.normsOffset;
+    for (size_t kind = 0; kind < (size_t)IVector::NORM::AMOUNT; kind++) {
+        if (count > 0 && _norms.isEnabled((IVector::NORM)kind)) {
+            header.norms |= (uint8_t)(1u << kind);
+            end += (uint64_t)count * sizeof(double);
+        }
+    }
+    // the index refers to physical rows, they are the saved rows only without tombstones
+    std::vector<char> image;
+    if (_index && dense) {
+        image.resize(_index->imageSize());
+    }
+    if (!image.empty()) {
+        _index->writeImage(image.data());
+        header.indexOffset = setfile::align(end);
+        header.indexSize = image.size();
+        end = header.indexOffset + header.indexSize;
+    }
+    header.fileSize = setfile::align(end);
+
+    FILE* file = fopen(path, "wb");
+    if (!file) {
+        SendWarning(getLogger(), RC::IO_ERROR);
+        return RC::IO_ERROR;
+    }
+    bool written = true;
+    uint64_t offset = 0;
+    auto put = [&](void const* bytes, size_t size) {
+        written = written && fwrite(bytes, 1, size, file) == size;
+        offset += size;
+    };
+    auto padTo = [&](uint64_t to) {
+        static const char zeros[setfile::alignment] = {};
+        while (offset < to) {
+            put(zeros, (size_t)std::min<uint64_t>(to - offset, sizeof(zeros)));
+        }
+    };
+    put(&header, sizeof(header));
+    padTo(header.dataOffset);
+    if (dense && count > 0) {
+        put(_data, count * vecDataSize());
+    } else {
+        for (size_t i = 0; i < _size; i++) {
+            if (!_tombstones.isDead(i)) {
+                put(rowAt(i), vecDataSize());
+            }
+        }
+    }
+    padTo(header.normsOffset);
+    for (size_t kind = 0; kind < (size_t)IVector::NORM::AMOUNT; kind++) {
+        if ((header.norms >> kind & 1) == 0) {
+            continue;
+        }
+        double const* norms = _norms.get((IVector::NORM)kind);
+        for (size_t i = 0; i < _size; i++) {
+            if (!_tombstones.isDead(i)) {
+                put(norms + i, sizeof(double));
+            }
+        }
+    }
+    if (!image.empty()) {
+        padTo(header.indexOffset);
+        put(image.data(), image.size());
+    }
+    padTo(header.fileSize);
+    written = fclose(file) == 0 && written;
+    if (!written) {
+        SendWarning(getLogger(), RC::IO_ERROR);
+        return RC::IO_ERROR;
+    }
+    return RC::SUCCESS;
+}
+
+/*
+* Sections have to lie within the file, so every sum below stays far from overflow
+*/
+static bool isValidHeader(setfile::Header const& header, uint64_t fileSize) {
+    if (memcmp(header.magic, setfile::magic, sizeof(header.magic)) != 0 || header.version != setfile::version
+        || header.headerSize != sizeof(header) || header.fileSize > fileSize) {
+        return false;
+    }
+    if (header.precision >= (uint8_t)ISet::PRECISION::AMOUNT || header.index >= (uint8_t)ISet::INDEX::AMOUNT
+        || header.norms >> (size_t)IVector::NORM::AMOUNT != 0) {
+        return false;
+    }
+    if (header.size == 0) {
+        return header.dim <= SIZE_MAX / sizeof(double);
+    }
+    uint64_t element = header.precision == (uint8_t)ISet::PRECISION::FLOAT32 ? sizeof(float) : sizeof(double);
+    if (header.dim == 0 || header.dim > fileSize / element || header.size > fileSize / (header.dim * element)) {
+        return false;
+    }
+    if (header.dataOffset % setfile::alignment != 0 || header.dataOffset < sizeof(header) || header.dataOffset > fileSize
+        || header.size * header.dim * element > fileSize - header.dataOffset) {
+        return false;
+    }
+    uint64_t kinds = 0;
+    for (size_t kind = 0; kind < (size_t)IVector::NORM::AMOUNT; kind++) {
+        kinds += header.norms >> kind & 1;
+    }
+    if (header.normsOffset % sizeof(double) != 0 || header.normsOffset > fileSize
+        || header.size * kinds > (fileSize - header.normsOffset) / sizeof(double)) {
+        return false;
+    }
+    return header.indexSize == 0 || (header.indexOffset % sizeof(uint64_t) == 0 && header.indexOffset <= fileSize
+        && header.indexSize <= fileSize - header.indexOffset);
+}
+
+ISet* Set::openMapped(const char* path, ILogger* pLogger) {
+#ifdef __unix__
+    if (!path || !setfile::isLittleEndian()) {
+        return nullptr;
+    }
+    int fd = open(path, O_RDONLY);
+    if (fd < 0) {
+        return nullptr;
+    }
+    struct stat info;
+    size_t mappingSize = 0;
+    void* mapping = MAP_FAILED;
+    if (fstat(fd, &info) == 0 && info.st_size >= (off_t)sizeof(setfile::Header)) {
+        mappingSize = (size_t)info.st_size;
+        // private pages are copied on first write, so modifications never reach the file
+        mapping = mmap(nullptr, mappingSize, PROT_READ | PROT_WRITE, MAP_PRIVATE, fd, 0);
+    }
+    close(fd);
+    if (mapping == MAP_FAILED) {
+        return nullptr;
+    }
+    setfile::Header header;
+    memcpy(&header, mapping, sizeof(header));
+    if (!isValidHeader(header, mappingSize)) {
+        munmap(mapping, mappingSize);
+        return nullptr;
+    }
+    Set* set = new Set((PRECISION)header.precision);
+    set->attachLogger(pLogger);
+    set->_indexType = (INDEX)header.index;
+    if (header.size > 0) {
+        set->adoptMapping(mapping, mappingSize, header);
+        return set;
+    }
+    munmap(mapping, mappingSize);
+    if (header.dim > 0 && !set->init((size_t)header.dim)) {
+        delete set;
+        return nullptr;
+    }
+    return set;
+#else
+    return nullptr;
+#endif
+}
+
+void Set::adoptMapping(void* mapping, size_t mappingSize, setfile::Header const& header) {
+    char* base = (char*)mapping;
+    _mapping = mapping;
+    _mappingSize = mappingSize;
+    _dim = (size_t)header.dim;
+    _data = base + header.dataOffset;
+    _size = (size_t)header.size;
+    _allocated = _size;
+
+    double const* norms = (double const*)(base + header.normsOffset);
+    for (size_t kind = 0; kind < (size_t)IVector::NORM::AMOUNT; kind++) {
+        if (header.norms >> kind & 1) {
+            _norms.assign((IVector::NORM)kind, norms, _size);
+            norms += _size;
+        }
+    }
+
+    _index = SetIndex::createIndex(_indexType, _dim);
+    if (_index && (header.indexSize == 0 || !_index->readImage(base + header.indexOffset, (size_t)header.indexSize, _size))) {
+        rebuildIndex();
+    }
 }
 
 RC ISet::setLogger(ILogger* const logger) {
     return Set::setLogger(logger);
 }
 
+RC ISet::setThreadLogger(ILogger* const logger) {
+    threadLogger = logger;
+    return RC::SUCCESS;
+}
+
+ILogger* ISet::getThreadLogger() {
+    return threadLogger;
+}
+
+RC ISet::setThreadCount(size_t threads) {
+    return Set::setThreadCount(threads);
+}
+
 ISet* ISet::createSet(ILogger* pLogger) {
-    setLogger(pLogger);
-    return new Set();
+    return createSet(pLogger, PRECISION::FLOAT64);
 }
 
-ISet* ISet::makeIntersection(ISet const * const& op1, ISet const * const& op2, IVector::NORM n, double tol) {
+ISet* ISet::createSet(ILogger* pLogger, PRECISION precision) {
 #ifndef FAST_MATH
-    if (op1->getDim() != op2->getDim()) {
+    if (precision >= PRECISION::AMOUNT) {
         return nullptr;
     }
 #endif
-    if (op1->getSize() == 0 || op2->getSize() == 0) {
-        return createSet(nullptr);
+    Set* set = new Set(precision);
+    set->attachLogger(pLogger);
+    return set;
+}
+
+ISet* ISet::createConcurrentSet(ILogger* pLogger) {
+    return createConcurrentSet(pLogger, PRECISION::FLOAT64);
+}
+
+ISet* ISet::createConcurrentSet(ILogger* pLogger, PRECISION precision) {
+    return ConcurrentSet::create(pLogger, precision);
+}
+
+ISet* ISet::openMapped(const char* const& path, ILogger* pLogger) {
+    return Set::openMapped(path, pLogger);
+}
+
+GridIndex* Set::makeGrid(double tol) const {
+    GridIndex* grid = new GridIndex(_dim);
+    Rows stored = rows();
+    for (size_t i = 0; i < _size; i++) {
+        if (!_tombstones.isDead(i)) {
+            grid->insert(stored, i, tol);
+        }
     }
+    return grid;
+}
 
-    const IVector* vec1 = nullptr;
-    const IVector* vec2 = nullptr;
-    // deep copying will be fixed after interface update
-    if (op1->get(0, vec1) != RC::SUCCESS || op2->get(0, vec2) != RC::SUCCESS) {
-        return nullptr;
+bool Set::contains(GridIndex const* grid, double const* pat, IVector::NORM n, double tol) const {
+    bool found = false;
+    size_t checked = 0;
+    Rows stored = rows();
+    grid->query(stored, pat, tol, [&](size_t row) {
+        checked++;
+        found = stored.distance(row, pat, n, tol) < tol;
+        return !found;
+    });
+    COUNT_STAT(_counters, DISTANCES, checked);
+    return found;
+}
+
+RC Set::insertFiltered(Set const* src, Set const* other, bool matched, IVector::NORM n, double tol) {
+    if (src->_size == 0) {
+        return RC::SUCCESS;
     }
-    
+    if (_dim == 0 && !init(src->_dim)) {
+        SendWarning(getLogger(), RC::ALLOCATION_ERROR);
+        return RC::ALLOCATION_ERROR;
+    }
+    // lookups run in parallel, insertion stays serial and in source order
+    Rows srcRows = src->rows();
+    std::vector<char> selected(src->_size, 1);
+    if (other) {
+        GridIndex* grid = other->makeGrid(tol);
+        forChunks(src->_size, [&](size_t begin, size_t end) {
+            std::vector<double> buffer(src->_dim);
+            for (size_t i = begin; i < end; i++) {
+                selected[i] = other->contains(grid, srcRows.read(i, buffer.data()), n, tol) == matched;
+            }
+        });
+        delete grid;
+    }
+    RC code = RC::SUCCESS;
+    std::vector<double> buffer(src->_dim);
+    for (size_t i = 0; i < src->_size && code == RC::SUCCESS; i++) {
+        if (selected[i] && !src->_tombstones.isDead(i)) {
+            code = insert(srcRows.read(i, buffer.data()), n, tol);
+        }
+    }
+    return code;
 }
 
-ISet* ISet::makeUnion(ISet const * const& op1, ISet const * const& op2, IVector::NORM n, double tol) {
+bool Set::isSubSet(Set const* op1, Set const* op2, IVector::NORM n, double tol) {
+    if (op1->_size == 0) {
+        return true;
+    }
+    GridIndex* grid = op2->makeGrid(tol);
+    std::atomic<bool> res(true);
+    Rows rows1 = op1->rows();
+    forChunks(op1->_size, [&](size_t begin, size_t end) {
+        std::vector<double> buffer(op1->_dim);
+        for (size_t i = begin; i < end && res; i++) {
+            if (!op1->_tombstones.isDead(i) && !op2->contains(grid, rows1.read(i, buffer.data()), n, tol)) {
+                res = false;
+            }
+        }
+    });
+    delete grid;
+    return res;
+}
+
+/*
+* Set algebra operand, the readable replica of a ConcurrentSet stays pinned while the operand lives
+*/
+class Operand {
+public:
+    Operand(ISet const* set) : _guard(dynamic_cast<ConcurrentSet const*>(set)) {
+        _set = (Set const*)(_guard.get() ? _guard.get() : set);
+    }
+
+    Set const* get() const {
+        return _set;
+    }
+
+private:
+    ConcurrentSet::ReadGuard _guard;
+    Set const* _set;
+};
 
+// empty sets have no dimension yet and are compatible with any set
+static bool compatible(Operand const& op1, Operand const& op2) {
+    Set const* set1 = op1.get();
+    Set const* set2 = op2.get();
+    return set1->getSize() == 0 || set2->getSize() == 0 || set1->getDim() == set2->getDim();
 }
 
-ISet* ISet::sub(ISet const * const& op1, ISet const * const& op2, IVector::NORM n, double tol) {
+/*
+* Both operands are tiled so that a tile of each stays in cache, tiles of this set are spread over the thread pool
+*/
+RC Set::pairwiseDistances(ISet const* other, IVector::NORM n, std::vector<double>& out) const {
+    dumpStats();
+    Operand op2(other);
+    Set const* set2 = op2.get();
+    out.clear();
+#ifndef FAST_MATH
+    if (n >= IVector::NORM::AMOUNT) {
+        SendWarning(getLogger(), RC::INVALID_ARGUMENT);
+        return RC::INVALID_ARGUMENT;
+    }
+    if (getSize() != 0 && set2->getSize() != 0 && _dim != set2->_dim) {
+        SendWarning(getLogger(), RC::MISMATCHING_DIMENSIONS);
+        return RC::MISMATCHING_DIMENSIONS;
+    }
+#endif
+    size_t rows1 = getSize(), rows2 = set2->getSize();
+    if (rows1 == 0 || rows2 == 0) {
+        return RC::SUCCESS;
+    }
+    std::vector<double> buffer1, buffer2;
+    double const* data1 = denseRows(buffer1);
+    double const* data2 = set2->denseRows(buffer2);
+    size_t dim = _dim;
+    out.resize(rows1 * rows2);
 
+    std::vector<double> norms1, norms2;
+    if (n == IVector::NORM::SECOND) {
+        norms1.resize(rows1);
+        norms2.resize(rows2);
+        for (size_t i = 0; i < rows1; i++) {
+            norms1[i] = kernels::dot(data1 + i * dim, data1 + i * dim, dim);
+        }
+        for (size_t j = 0; j < rows2; j++) {
+            norms2[j] = kernels::dot(data2 + j * dim, data2 + j * dim, dim);
+        }
+    }
+
+    COUNT_STAT(_counters, DISTANCES, rows1 * rows2);
+    size_t tile = std::max<size_t>(1, std::min(maxTileRows, tileBytes / (dim * sizeof(double))));
+    forChunks((rows1 + tile - 1) / tile, 1, [&](size_t begin, size_t end) {
+        size_t first1 = begin * tile, last1 = std::min(end * tile, rows1);
+        for (size_t first2 = 0; first2 < rows2; first2 += tile) {
+            size_t last2 = std::min(first2 + tile, rows2);
+            for (size_t i = first1; i < last1; i++) {
+                double const* row1 = data1 + i * dim;
+                double* dest = out.data() + i * rows2;
+                for (size_t j = first2; j < last2; j++) {
+                    double const* row2 = data2 + j * dim;
+                    if (n != IVector::NORM::SECOND) {
+                        dest[j] = kernels::distance(row1, row2, dim, n);
+                        continue;
+                    }
+                    double sum = norms1[i] + norms2[j];
+                    double squared = sum - 2 * kernels::dot(row1, row2, dim);
+                    dest[j] = squared > cancellationBound * sum ? std::sqrt(squared) : kernels::distance(row1, row2, dim, n);
+                }
+            }
+        }
+    });
+    return RC::SUCCESS;
 }
 
-ISet* ISet::symSub(ISet const * const& op1, ISet const * const& op2, IVector::NORM n, double tol) {
+/*
+* Only tiles on and above the diagonal are computed, each is mirrored by the thread that computed it
+*/
+RC Set::gram(std::vector<double>& out) const {
+    dumpStats();
+    out.clear();
+    size_t count = getSize();
+    if (count == 0) {
+        return RC::SUCCESS;
+    }
+    std::vector<double> buffer;
+    double const* data = denseRows(buffer);
+    size_t dim = _dim;
+    out.resize(count * count);
 
+    // one product per pair, the other half of the matrix is mirrored
+    COUNT_STAT(_counters, DISTANCES, count * (count + 1) / 2);
+    size_t tile = std::max<size_t>(1, std::min(maxTileRows, tileBytes / (dim * sizeof(double))));
+    forChunks((count + tile - 1) / tile, 1, [&](size_t begin, size_t end) {
+        size_t first1 = begin * tile, last1 = std::min(end * tile, count);
+        for (size_t first2 = first1; first2 < count; first2 += tile) {
+            size_t last2 = std::min(first2 + tile, count);
+            for (size_t i = first1; i < last1; i++) {
+                for (size_t j = std::max(first2, i); j < last2; j++) {
+                    double dot = kernels::dot(data + i * dim, data + j * dim, dim);
+                    out[i * count + j] = dot;
+                    out[j * count + i] = dot;
+                }
+            }
+        }
+    });
+    return RC::SUCCESS;
 }
-bool equals(ISet const * const& op1, ISet const * const& op2, IVector::NORM n, double tol) {
 
+ISet* ISet::makeIntersection(ISet const * const& op1, ISet const * const& op2, IVector::NORM n, double tol) {
+    Operand set1(op1), set2(op2);
+#ifndef FAST_MATH
+    if (!compatible(set1, set2) || n >= IVector::NORM::AMOUNT) {
+        return nullptr;
+    }
+#endif
+    Set* res = new Set(set1.get()->getPrecision());
+    res->attachLogger(set1.get()->_instanceLogger);
+    if (res->insertFiltered(set1.get(), set2.get(), true, n, tol) != RC::SUCCESS) {
+        delete res;
+        return nullptr;
+    }
+    return res;
 }
 
-bool subSet(ISet const * const& op1, ISet const * const& op2, IVector::NORM n, double tol) {
+ISet* ISet::makeUnion(ISet const * const& op1, ISet const * const& op2, IVector::NORM n, double tol) {
+    Operand set1(op1), set2(op2);
+#ifndef FAST_MATH
+    if (!compatible(set1, set2) || n >= IVector::NORM::AMOUNT) {
+        return nullptr;
+    }
+#endif
+    Set* res = new Set(set1.get()->getPrecision());
+    res->attachLogger(set1.get()->_instanceLogger);
+    if (res->insertFiltered(set1.get(), nullptr, true, n, tol) != RC::SUCCESS ||
+        res->insertFiltered(set2.get(), nullptr, true, n, tol) != RC::SUCCESS) {
+        delete res;
+        return nullptr;
+    }
+    return res;
+}
 
+ISet* ISet::sub(ISet const * const& op1, ISet const * const& op2, IVector::NORM n, double tol) {
+    Operand set1(op1), set2(op2);
+#ifndef FAST_MATH
+    if (!compatible(set1, set2) || n >= IVector::NORM::AMOUNT) {
+        return nullptr;
+    }
+#endif
+    Set* res = new Set(set1.get()->getPrecision());
+    res->attachLogger(set1.get()->_instanceLogger);
+    if (res->insertFiltered(set1.get(), set2.get(), false, n, tol) != RC::SUCCESS) {
+        delete res;
+        return nullptr;
+    }
+    return res;
+}
+
+ISet* ISet::symSub(ISet const * const& op1, ISet const * const& op2, IVector::NORM n, double tol) {
+    Operand set1(op1), set2(op2);
+#ifndef FAST_MATH
+    if (!compatible(set1, set2) || n >= IVector::NORM::AMOUNT) {
+        return nullptr;
+    }
+#endif
+    Set* res = new Set(set1.get()->getPrecision());
+    res->attachLogger(set1.get()->_instanceLogger);
+    if (res->insertFiltered(set1.get(), set2.get(), false, n, tol) != RC::SUCCESS ||
+        res->insertFiltered(set2.get(), set1.get(), false, n, tol) != RC::SUCCESS) {
+        delete res;
+        return nullptr;
+    }
+    return res;
+}
+
+bool ISet::equals(ISet const * const& op1, ISet const * const& op2, IVector::NORM n, double tol) {
+    Operand set1(op1), set2(op2);
+#ifndef FAST_MATH
+    if (!compatible(set1, set2) || n >= IVector::NORM::AMOUNT) {
+        return false;
+    }
+#endif
+    return Set::isSubSet(set1.get(), set2.get(), n, tol) && Set::isSubSet(set2.get(), set1.get(), n, tol);
+}
+
+bool ISet::subSet(ISet const * const& op1, ISet const * const& op2, IVector::NORM n, double tol) {
+    Operand set1(op1), set2(op2);
+#ifndef FAST_MATH
+    if (!compatible(set1, set2) || n >= IVector::NORM::AMOUNT) {
+        return false;
+    }
+#endif
+    return Set::isSubSet(set1.get(), set2.get(), n, tol);
 }
 
 ISet::~ISet() = default;
\ No newline at end of file
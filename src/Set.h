@@ -1,42 +1,160 @@
 #pragma once
+#include <atomic>
+#include <memory>
 #include "../include/ISet.h"
+#include "Counters.h"
+#include "NormCache.h"
+#include "SetFileFormat.h"
+#include "SetIndex.h"
+#include "Rows.h"
+#include "ThreadPool.h"
+#include "Tombstones.h"
 
 namespace {
 
 class Set:public ISet {
 public:
-	Set();
+	Set(PRECISION precision);
     
     static RC setLogger(ILogger* const logger);
+    static RC setThreadCount(size_t threads);
 
     virtual size_t getDim() const override;
 	virtual size_t getSize() const override;
+	virtual PRECISION getPrecision() const override;
     virtual RC get(size_t index, IVector const*& val) const override;
 	virtual RC findFirst(IVector const * const& pat, IVector::NORM n, double tol, IVector const *& val) const override;
+	virtual RC getView(size_t index, IVectorView& view) const override;
+	virtual RC findFirstView(IVector const * const& pat, IVector::NORM n, double tol, IVectorView& view) const override;
+	virtual RC findAll(IVector const * const& pat, IVector::NORM n, double tol, std::vector<size_t>& indices) const override;
+	virtual RC findKNearest(IVector const * const& pat, IVector::NORM n, size_t k, std::vector<size_t>& indices, std::vector<double>& dists) const override;
+	virtual RC pairwiseDistances(ISet const* other, IVector::NORM n, std::vector<double>& out) const override;
+	virtual RC gram(std::vector<double>& out) const override;
 
 	virtual RC insert(IVector const *& val, IVector::NORM n, double tol) override;
+	virtual RC insertBatch(double const* rows, size_t dim, size_t count, IVector::NORM n, double tol) override;
+	virtual RC insertStream(const RowReader& read, size_t dim, IVector::NORM n, double tol) override;
+	virtual RC insertFile(const char* const& path, size_t dim, IVector::NORM n, double tol) override;
 
 	virtual RC remove(size_t index) override;
 	virtual RC remove(IVector const * const& pat, IVector::NORM n, double tol) override;
+	virtual RC removeIf(const std::function<bool(double const* vec)>& predicate) override;
+
+	virtual RC setRemoveMode(REMOVE_MODE mode) override;
+	virtual REMOVE_MODE getRemoveMode() const override;
+	virtual RC compact() override;
+
+	virtual RC setIndex(INDEX type) override;
+	virtual INDEX getIndex() const override;
+
+	virtual RC reserve(size_t capacity) override;
+	virtual RC shrinkToFit() override;
+	virtual RC setGrowthFactor(double factor) override;
+	virtual size_t sizeAllocated() const override;
+
+	virtual RC attachLogger(ILogger* logger) override;
+	virtual ILogger* getLogger() const override;
+
+
+	virtual RC getStats(Stats& stats) const override;
+	virtual RC resetStats() override;
+	virtual RC setStatsDump(size_t milliseconds) override;
+
+	virtual RC save(const char* const& path) const override;
+	static ISet* openMapped(const char* path, ILogger* pLogger);
 
 	virtual ~Set();
 
 private:	
+	friend class ISet;
+
 	Set(const ISet& other);
 	Set& operator=(const ISet& other);
 
-    static ILogger* _logger;
+    static std::atomic<ILogger*> _logger;
+    // accessed with std::atomic_load() and std::atomic_store() only: a loop keeps the pool it started on alive
+    // while setThreadCount() replaces it
+    static std::shared_ptr<ThreadPool> _pool;
 
-    double* _data;
+    /*
+    * Runs body over consecutive chunks of [0, count), in parallel if a thread pool is set
+    */
+    static void forChunks(size_t count, const ThreadPool::Body& body);
+    static void forChunks(size_t count, size_t grain, const ThreadPool::Body& body);
+
+    char* _data;
+    // file mapping _data points into after openMapped(), nullptr once storage is in memory
+    void* _mapping;
+    size_t _mappingSize;
     size_t _dim;
+    PRECISION _precision;
     size_t _allocated;
+    size_t _reserved;
     size_t _size;
+    double _growthFactor;
+    INDEX _indexType;
+    SetIndex* _index;
+    REMOVE_MODE _removeMode;
+    ILogger* _instanceLogger;
+    Tombstones _tombstones;
+    NormCache _norms;
+    mutable Counters _counters;
 
     size_t vecDataSize() const;
+    char* rowAt(size_t row) const;
+    Rows rows() const;
+    void writeRow(size_t row, double const* src);
+
+    /*
+    * Rows are physical positions in _data, _size counts tombstoned rows too
+    * Indices seen through ISet skip tombstones
+    */
+    RC getRow(size_t row, IVector const*& val) const;
+    void removeRow(size_t row);
+    RC rebuildIndex();
+
+    /*
+    * Writes stats to the logger if setStatsDump() made a dump due, called on entry to queries and modifications
+    */
+    void dumpStats() const;
+
+    /*
+    * Live rows as contiguous doubles: the storage itself when possible, otherwise packed into `buffer`
+    */
+    double const* denseRows(std::vector<double>& buffer) const;
+
+    RC findFirst(IVector const * const& pat, IVector::NORM n, double tol, size_t& row) const;
+    RC findFirst(double const* pat, IVector::NORM n, double tol, size_t& row) const;
+    RC insert(double const* row, IVector::NORM n, double tol);
+
+    /*
+    * Bulk insertion: rows are looked up in `members`, an index over all rows that is extended with the batch,
+    * or in _index if it's nullptr. The batch is appended and indexed at once, dropped rows are taken out after
+    */
+    RC beginBatch(size_t dim);
+    RC insertRows(double const* data, size_t count, IVector::NORM n, double tol, SetIndex* members);
+
+    /*
+    * Storage is a 64-byte aligned block of _allocated rows of doubles or floats, dimension is fixed by the first inserted vector
+    */
+    bool init(size_t dim);
+    bool reallocate(size_t capacity);
+    bool grow(size_t required);
+    void releaseData();
 
-    RC findFirst(IVector const * const& pat, IVector::NORM n, double tol, IVector *& val, size_t& index) const;
+    /*
+    * Takes over rows, norms and index of a non-empty file checked by openMapped(), an index image that doesn't
+    * fit the rows is dropped and the index rebuilt
+    */
+    void adoptMapping(void* mapping, size_t mappingSize, setfile::Header const& header);
 
-    bool allocate();
+    /*
+    * Set algebra helpers, `other` is hashed once into a grid with cell edge tol, so every lookup probes a few cells
+    */
+    GridIndex* makeGrid(double tol) const;
+    bool contains(GridIndex const* grid, double const* pat, IVector::NORM n, double tol) const;
+    RC insertFiltered(Set const* src, Set const* other, bool matched, IVector::NORM n, double tol);
+    static bool isSubSet(Set const* op1, Set const* op2, IVector::NORM n, double tol);
 protected:
 };
 
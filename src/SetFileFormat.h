@@ -0,0 +1,71 @@
+#pragma once
+#include <cstdint>
+#include <cstring>
+
+/*
+* On-disk layout of sets written by ISet::save() and read by ISet::openMapped()
+*
+* A Header is followed by sections at 64-byte aligned offsets, all little-endian:
+* - rows: `size` vectors of `dim` doubles (or floats for FLOAT32 sets), row-major, exactly as a Set stores them
+* - norms: for every bit set in `norms`, in NORM order, `size` doubles with the norms of the rows
+* - index: image of the set index, see KdTreeHeader, absent if the index is rebuilt from the rows on load
+* Gaps between sections are zero
+*/
+namespace setfile {
+
+constexpr char magic[8] = { 'R', 'C', 'S', 'E', 'T', 'M', 'A', 'P' };
+constexpr uint32_t version = 1;
+constexpr uint64_t alignment = 64;
+
+struct Header {
+    char magic[8];
+    uint32_t version;
+    uint32_t headerSize;
+    uint64_t dim;          // 0 for a set nothing was ever inserted into
+    uint64_t size;         // Rows stored
+    uint8_t precision;     // ISet::PRECISION
+    uint8_t index;         // ISet::INDEX
+    uint8_t norms;         // Bit n is set if norms of IVector::NORM n are stored
+    uint8_t reserved0[5];
+    uint64_t dataOffset;
+    uint64_t normsOffset;
+    uint64_t indexOffset;  // 0 if there is no index image
+    uint64_t indexSize;    // Bytes
+    uint64_t fileSize;
+    uint64_t reserved[6];
+};
+
+/*
+* Image of a k-d tree: header followed by `nodes` nodes, children always come after their parent
+*/
+struct KdTreeHeader {
+    uint64_t root;
+    uint64_t alive;
+    uint64_t sinceRebuild;
+    uint64_t nodes;
+};
+
+struct KdTreeNode {
+    uint64_t row;   // npos for a removed row
+    double split;
+    uint64_t left;  // npos for none
+    uint64_t right;
+};
+
+constexpr uint64_t npos = UINT64_MAX;
+
+static_assert(sizeof(Header) == 128, "header layout is part of the format");
+static_assert(sizeof(KdTreeHeader) == 32 && sizeof(KdTreeNode) == 32, "node layout is part of the format");
+
+inline uint64_t align(uint64_t offset) {
+    return (offset + alignment - 1) / alignment * alignment;
+}
+
+inline bool isLittleEndian() {
+    uint16_t probe = 1;
+    unsigned char first = 0;
+    memcpy(&first, &probe, 1);
+    return first == 1;
+}
+
+}
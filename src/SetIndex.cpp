@@ -0,0 +1,826 @@
+#include <algorithm>
+#include <cfloat>
+#include <cmath>
+#include <cstring>
+#include <iterator>
+#include "SetFileFormat.h"
+#include "SetIndex.h"
+
+SetIndex* SetIndex::createIndex(ISet::INDEX type, size_t dim) {
+    switch (type) {
+    case ISet::INDEX::GRID:
+        return new GridIndex(dim);
+    case ISet::INDEX::KD_TREE:
+        return new KdTreeIndex(dim);
+    case ISet::INDEX::SORTED:
+        return new SortedIndex(dim);
+    default:
+        return nullptr;
+    }
+}
+
+RC SetIndex::rebuild(Rows const& rows, size_t size) {
+    clear();
+    for (size_t i = 0; i < size; i++) {
+        RC code = insert(rows, i, 0);
+        if (code != RC::SUCCESS) {
+            return code;
+        }
+    }
+    return RC::SUCCESS;
+}
+
+RC SetIndex::append(Rows const& rows, size_t from, size_t to, double tol) {
+    for (size_t row = from; row < to; row++) {
+        RC code = insert(rows, row, tol);
+        if (code != RC::SUCCESS) {
+            return code;
+        }
+    }
+    return RC::SUCCESS;
+}
+
+size_t SetIndex::imageSize() const {
+    return 0;
+}
+
+void SetIndex::writeImage(char*) const {
+}
+
+bool SetIndex::readImage(char const*, size_t, size_t) {
+    return false;
+}
+
+/*
+* GridIndex
+*/
+
+GridIndex::GridIndex(size_t dim) : SetIndex(dim) {
+    _axes = std::min(dim, maxHashedAxes);
+    _cell = 0;
+}
+
+bool GridIndex::Key::operator==(const Key& other) const {
+    for (size_t i = 0; i < maxHashedAxes; i++) {
+        if (cells[i] != other.cells[i]) {
+            return false;
+        }
+    }
+    return true;
+}
+
+size_t GridIndex::KeyHash::operator()(const Key& key) const {
+    uint64_t hash = 0x9E3779B97F4A7C15ull;
+    for (size_t i = 0; i < maxHashedAxes; i++) {
+        hash ^= (uint64_t)key.cells[i] + 0x9E3779B97F4A7C15ull + (hash << 6) + (hash >> 2);
+    }
+    return (size_t)hash;
+}
+
+ISet::INDEX GridIndex::getType() const {
+    return ISet::INDEX::GRID;
+}
+
+long long GridIndex::cellOf(double cord) const {
+    constexpr double bound = 4e18;
+    double cell = std::floor(cord / _cell);
+    return (long long)std::fmax(-bound, std::fmin(bound, cell));
+}
+
+GridIndex::Key GridIndex::keyOf(double const* vec) const {
+    Key key = {};
+    for (size_t i = 0; i < _axes; i++) {
+        key.cells[i] = cellOf(vec[i]);
+    }
+    return key;
+}
+
+GridIndex::Key GridIndex::keyOf(Rows const& rows, size_t row) const {
+    Key key = {};
+    for (size_t i = 0; i < _axes; i++) {
+        key.cells[i] = cellOf(rows.get(row, i));
+    }
+    return key;
+}
+
+RC GridIndex::insert(Rows const& rows, size_t row, double tol) {
+    if (_cell == 0) {
+        if (!(tol > 0) || std::isinf(tol)) {
+            _pending.push_back(row);
+            return RC::SUCCESS;
+        }
+        _cell = tol;
+        for (size_t pendingRow : _pending) {
+            _cells[keyOf(rows, pendingRow)].push_back(pendingRow);
+        }
+        _pending.clear();
+    }
+    _cells[keyOf(rows, row)].push_back(row);
+    return RC::SUCCESS;
+}
+
+std::vector<size_t>* GridIndex::rowsOf(Rows const& rows, size_t row) {
+    if (_cell == 0) {
+        return &_pending;
+    }
+    auto cell = _cells.find(keyOf(rows, row));
+    return cell == _cells.end() ? nullptr : &cell->second;
+}
+
+RC GridIndex::remove(Rows const& rows, size_t row) {
+    std::vector<size_t>* cell = rowsOf(rows, row);
+    if (!cell) {
+        return RC::VECTOR_NOT_FOUND;
+    }
+    auto it = std::find(cell->begin(), cell->end(), row);
+    if (it == cell->end()) {
+        return RC::VECTOR_NOT_FOUND;
+    }
+    cell->erase(it);
+    if (cell->empty() && cell != &_pending) {
+        _cells.erase(keyOf(rows, row));
+    }
+    return RC::SUCCESS;
+}
+
+void GridIndex::shift(size_t row) {
+    auto renumber = [row](std::vector<size_t>& rows) {
+        for (size_t& other : rows) {
+            if (other > row) {
+                other--;
+            }
+        }
+    };
+    renumber(_pending);
+    for (auto& entry : _cells) {
+        renumber(entry.second);
+    }
+}
+
+RC GridIndex::move(Rows const& rows, size_t from, size_t to) {
+    std::vector<size_t>* cell = rowsOf(rows, from);
+    if (!cell) {
+        return RC::VECTOR_NOT_FOUND;
+    }
+    auto it = std::find(cell->begin(), cell->end(), from);
+    if (it == cell->end()) {
+        return RC::VECTOR_NOT_FOUND;
+    }
+    *it = to;
+    return RC::SUCCESS;
+}
+
+void GridIndex::clear() {
+    _pending.clear();
+    _cells.clear();
+}
+
+void GridIndex::query(Rows const&, double const* pat, double tol, const Visitor& visit) const {
+    for (size_t row : _pending) {
+        if (!visit(row)) {
+            return;
+        }
+    }
+    if (_cells.empty() || !(tol > 0)) {
+        return;
+    }
+
+    double radius = std::ceil(tol / _cell);
+    if (!(radius <= maxProbeRadius)) {
+        for (auto& entry : _cells) {
+            for (size_t row : entry.second) {
+                if (!visit(row)) {
+                    return;
+                }
+            }
+        }
+        return;
+    }
+
+    long long r = (long long)radius;
+    Key center = keyOf(pat);
+    Key probe = center;
+    long long offsets[maxHashedAxes] = {};
+    for (size_t i = 0; i < _axes; i++) {
+        offsets[i] = -r;
+    }
+    while (true) {
+        for (size_t i = 0; i < _axes; i++) {
+            probe.cells[i] = center.cells[i] + offsets[i];
+        }
+        auto cell = _cells.find(probe);
+        if (cell != _cells.end()) {
+            for (size_t row : cell->second) {
+                if (!visit(row)) {
+                    return;
+                }
+            }
+        }
+
+        size_t axis = 0;
+        while (axis < _axes && offsets[axis] == r) {
+            offsets[axis] = -r;
+            axis++;
+        }
+        if (axis == _axes) {
+            break;
+        }
+        offsets[axis]++;
+    }
+}
+
+size_t GridIndex::sizeAllocated() const {
+    size_t size = sizeof(GridIndex) + _pending.capacity() * sizeof(size_t);
+    size += _cells.bucket_count() * sizeof(void*);
+    for (auto& entry : _cells) {
+        // hash node holds the key, the vector header and the next pointer
+        size += sizeof(entry) + sizeof(void*) + entry.second.capacity() * sizeof(size_t);
+    }
+    return size;
+}
+
+void GridIndex::shrinkToFit(Rows const&) {
+    _pending.shrink_to_fit();
+    for (auto& entry : _cells) {
+        entry.second.shrink_to_fit();
+    }
+    _cells.rehash(0);
+}
+
+/*
+* KdTreeIndex
+*/
+
+KdTreeIndex::KdTreeIndex(size_t dim) : SetIndex(dim) {
+    _root = npos;
+    _alive = 0;
+    _sinceRebuild = 0;
+}
+
+ISet::INDEX KdTreeIndex::getType() const {
+    return ISet::INDEX::KD_TREE;
+}
+
+size_t KdTreeIndex::build(Rows const& rows, std::vector<size_t>& order, size_t from, size_t to, size_t depth) {
+    if (from >= to) {
+        return npos;
+    }
+    size_t axis = depth % _dim;
+    auto cord = [&](size_t row) { return rows.get(row, axis); };
+    auto first = order.begin() + from;
+    auto last = order.begin() + to;
+
+    std::nth_element(first, first + (to - from) / 2, last, [&](size_t a, size_t b) { return cord(a) < cord(b); });
+    double split = cord(*(first + (to - from) / 2));
+    // equal coordinates have to go right, the same way insert() and remove() descend
+    auto pivot = std::partition(first, last, [&](size_t row) { return cord(row) < split; });
+    std::iter_swap(pivot, std::find_if(pivot, last, [&](size_t row) { return cord(row) == split; }));
+    size_t mid = pivot - order.begin();
+
+    size_t node = _nodes.size();
+    _nodes.push_back({ order[mid], split, npos, npos });
+    size_t left = build(rows, order, from, mid, depth + 1);
+    size_t right = build(rows, order, mid + 1, to, depth + 1);
+    _nodes[node].left = left;
+    _nodes[node].right = right;
+    return node;
+}
+
+void KdTreeIndex::compact(Rows const& rows) {
+    std::vector<size_t> order;
+    order.reserve(_alive);
+    for (const Node& node : _nodes) {
+        if (node.row != npos) {
+            order.push_back(node.row);
+        }
+    }
+    _nodes.clear();
+    _nodes.reserve(order.size());
+    _root = build(rows, order, 0, order.size(), 0);
+    _sinceRebuild = 0;
+}
+
+RC KdTreeIndex::insert(Rows const& rows, size_t row, double) {
+    size_t parent = npos;
+    size_t node = _root;
+    size_t depth = 0;
+    while (node != npos) {
+        parent = node;
+        node = rows.get(row, depth % _dim) < _nodes[node].split ? _nodes[node].left : _nodes[node].right;
+        depth++;
+    }
+    node = _nodes.size();
+    _nodes.push_back({ row, rows.get(row, depth % _dim), npos, npos });
+    if (parent == npos) {
+        _root = node;
+    } else if (rows.get(row, (depth - 1) % _dim) < _nodes[parent].split) {
+        _nodes[parent].left = node;
+    } else {
+        _nodes[parent].right = node;
+    }
+    _alive++;
+    _sinceRebuild++;
+
+    size_t bound = 2 * (size_t)std::log2((double)_alive + 1) + 8;
+    if (depth > bound && 4 * _sinceRebuild >= _alive) {
+        compact(rows);
+    }
+    return RC::SUCCESS;
+}
+
+size_t KdTreeIndex::find(Rows const& rows, size_t row) const {
+    size_t node = _root;
+    size_t depth = 0;
+    while (node != npos && _nodes[node].row != row) {
+        node = rows.get(row, depth % _dim) < _nodes[node].split ? _nodes[node].left : _nodes[node].right;
+        depth++;
+    }
+    return node;
+}
+
+RC KdTreeIndex::remove(Rows const& rows, size_t row) {
+    size_t node = find(rows, row);
+    if (node == npos) {
+        return RC::VECTOR_NOT_FOUND;
+    }
+    _nodes[node].row = npos;
+    _alive--;
+
+    if (_nodes.size() > 2 * _alive) {
+        compact(rows);
+    }
+    return RC::SUCCESS;
+}
+
+void KdTreeIndex::shift(size_t row) {
+    for (Node& node : _nodes) {
+        if (node.row != npos && node.row > row) {
+            node.row--;
+        }
+    }
+}
+
+RC KdTreeIndex::move(Rows const& rows, size_t from, size_t to) {
+    size_t node = find(rows, from);
+    if (node == npos) {
+        return RC::VECTOR_NOT_FOUND;
+    }
+    _nodes[node].row = to;
+    return RC::SUCCESS;
+}
+
+void KdTreeIndex::clear() {
+    _nodes.clear();
+    _root = npos;
+    _alive = 0;
+    _sinceRebuild = 0;
+}
+
+void KdTreeIndex::query(Rows const&, double const* pat, double tol, const Visitor& visit) const {
+    if (_root == npos) {
+        return;
+    }
+    std::vector<std::pair<size_t, size_t>> stack;
+    stack.push_back({ _root, 0 });
+    while (!stack.empty()) {
+        size_t node = stack.back().first;
+        size_t depth = stack.back().second;
+        stack.pop_back();
+
+        const Node& cur = _nodes[node];
+        if (cur.row != npos && !visit(cur.row)) {
+            return;
+        }
+        // every coordinate difference bounds all supported norms from below
+        double diff = pat[depth % _dim] - cur.split;
+        if (cur.left != npos && diff < tol) {
+            stack.push_back({ cur.left, depth + 1 });
+        }
+        if (cur.right != npos && -diff < tol) {
+            stack.push_back({ cur.right, depth + 1 });
+        }
+    }
+}
+
+RC KdTreeIndex::rebuild(Rows const& rows, size_t size) {
+    std::vector<size_t> order(size);
+    for (size_t i = 0; i < size; i++) {
+        order[i] = i;
+    }
+    clear();
+    _nodes.reserve(size);
+    _root = build(rows, order, 0, size, 0);
+    _alive = size;
+    return RC::SUCCESS;
+}
+
+RC KdTreeIndex::append(Rows const& rows, size_t from, size_t to, double tol) {
+    // a batch as large as the tree is cheaper to build balanced together with it than to descend row by row
+    if (to - from < _alive) {
+        return SetIndex::append(rows, from, to, tol);
+    }
+    std::vector<size_t> order;
+    order.reserve(_alive + to - from);
+    for (const Node& node : _nodes) {
+        if (node.row != npos) {
+            order.push_back(node.row);
+        }
+    }
+    for (size_t row = from; row < to; row++) {
+        order.push_back(row);
+    }
+    _nodes.clear();
+    _nodes.reserve(order.size());
+    _root = build(rows, order, 0, order.size(), 0);
+    _alive = order.size();
+    _sinceRebuild = 0;
+    return RC::SUCCESS;
+}
+
+void KdTreeIndex::shrinkToFit(Rows const& rows) {
+    if (_nodes.size() > _alive) {
+        compact(rows);
+    }
+    _nodes.shrink_to_fit();
+}
+
+size_t KdTreeIndex::sizeAllocated() const {
+    return sizeof(KdTreeIndex) + _nodes.capacity() * sizeof(Node);
+}
+
+size_t KdTreeIndex::imageSize() const {
+    return sizeof(setfile::KdTreeHeader) + _nodes.size() * sizeof(setfile::KdTreeNode);
+}
+
+void KdTreeIndex::writeImage(char* image) const {
+    auto link = [](size_t value) { return value == npos ? setfile::npos : (uint64_t)value; };
+    setfile::KdTreeHeader header = { link(_root), _alive, _sinceRebuild, _nodes.size() };
+    memcpy(image, &header, sizeof(header));
+    image += sizeof(header);
+    for (const Node& node : _nodes) {
+        setfile::KdTreeNode stored = { link(node.row), node.split, link(node.left), link(node.right) };
+        memcpy(image, &stored, sizeof(stored));
+        image += sizeof(stored);
+    }
+}
+
+bool KdTreeIndex::readImage(char const* image, size_t bytes, size_t size) {
+    setfile::KdTreeHeader header;
+    if (bytes < sizeof(header)) {
+        return false;
+    }
+    memcpy(&header, image, sizeof(header));
+    if (header.nodes > (bytes - sizeof(header)) / sizeof(setfile::KdTreeNode) || header.alive != size) {
+        return false;
+    }
+    image += sizeof(header);
+
+    // children come after their parent, so a valid image has no cycles, and every row is held by exactly one node
+    std::vector<Node> nodes((size_t)header.nodes);
+    std::vector<bool> seen(size, false);
+    size_t alive = 0;
+    for (size_t i = 0; i < nodes.size(); i++) {
+        setfile::KdTreeNode stored;
+        memcpy(&stored, image + i * sizeof(stored), sizeof(stored));
+        auto child = [&](uint64_t link) { return link == setfile::npos || (link > i && link < header.nodes); };
+        if (!child(stored.left) || !child(stored.right)) {
+            return false;
+        }
+        if (stored.row != setfile::npos) {
+            if (stored.row >= size || seen[(size_t)stored.row]) {
+                return false;
+            }
+            seen[(size_t)stored.row] = true;
+            alive++;
+        }
+        auto unlink = [](uint64_t value) { return value == setfile::npos ? npos : (size_t)value; };
+        nodes[i] = { unlink(stored.row), stored.split, unlink(stored.left), unlink(stored.right) };
+    }
+    if (alive != size || (header.root == setfile::npos ? size != 0 : header.root >= header.nodes)) {
+        return false;
+    }
+    _nodes.swap(nodes);
+    _root = header.root == setfile::npos ? npos : (size_t)header.root;
+    _alive = alive;
+    _sinceRebuild = (size_t)header.sinceRebuild;
+    return true;
+}
+
+/*
+* SortedIndex
+*/
+
+constexpr size_t axisIterations = 32;
+constexpr double axisPrecision = 1e-9;
+
+SortedIndex::SortedIndex(size_t dim) : SetIndex(dim) {
+    _axis.assign(dim, 0);
+    _axis[0] = 1;
+    _alive = 0;
+    _dead = 0;
+    _fitted = 0;
+    _magnitude = 0;
+}
+
+ISet::INDEX SortedIndex::getType() const {
+    return ISet::INDEX::SORTED;
+}
+
+double SortedIndex::keyOf(double const* vec) const {
+    double key = 0;
+    for (size_t i = 0; i < _dim; i++) {
+        key += _axis[i] * vec[i];
+    }
+    return key;
+}
+
+SortedIndex::Entry SortedIndex::entryOf(Rows const& rows, size_t row) {
+    Entry entry = { 0, {}, row };
+    for (size_t i = 0; i < _dim; i++) {
+        double cord = rows.get(row, i);
+        entry.key += _axis[i] * cord;
+        if (i < storedAxes) {
+            entry.cords[i] = cord;
+        }
+        if (std::isfinite(cord)) {
+            _magnitude = std::max(_magnitude, std::fabs(cord));
+        }
+    }
+    return entry;
+}
+
+void SortedIndex::add(Entry const& entry) {
+    if (std::isnan(entry.key)) {
+        _unordered.push_back(entry);
+    } else {
+        _tail.push_back(entry);
+    }
+    _alive++;
+}
+
+void SortedIndex::merge() {
+    auto byKey = [](Entry const& a, Entry const& b) { return a.key < b.key; };
+    std::sort(_tail.begin(), _tail.end(), byKey);
+    std::vector<Entry> merged;
+    merged.reserve(_sorted.size() - _dead + _tail.size());
+    std::merge(_sorted.begin(), _sorted.end(), _tail.begin(), _tail.end(), std::back_inserter(merged), byKey);
+    if (_dead > 0) {
+        merged.erase(std::remove_if(merged.begin(), merged.end(), [](Entry const& entry) { return entry.row == npos; }), merged.end());
+    }
+    _sorted.swap(merged);
+    _tail.clear();
+    _dead = 0;
+}
+
+/*
+* Principal axis by power iteration over the covariance of the finite rows, the previous axis is kept if they
+* don't spread in any direction
+*/
+void SortedIndex::refit(Rows const& rows, std::vector<size_t> const& live) {
+    std::vector<double> buffer(_dim), mean(_dim, 0), axis(_dim), next(_dim);
+    auto finite = [&](double const* vec) {
+        for (size_t i = 0; i < _dim; i++) {
+            if (!std::isfinite(vec[i])) {
+                return false;
+            }
+        }
+        return true;
+    };
+    size_t count = 0;
+    for (size_t row : live) {
+        double const* vec = rows.read(row, buffer.data());
+        if (finite(vec)) {
+            for (size_t i = 0; i < _dim; i++) {
+                mean[i] += vec[i];
+            }
+            count++;
+        }
+    }
+    bool fitted = false;
+    if (count > 1) {
+        for (size_t i = 0; i < _dim; i++) {
+            mean[i] /= (double)count;
+            // uneven start, a symmetric cloud is unlikely to be orthogonal to it
+            axis[i] = 1.0 + (double)i;
+        }
+        for (size_t iteration = 0; iteration < axisIterations; iteration++) {
+            std::fill(next.begin(), next.end(), 0.0);
+            for (size_t row : live) {
+                double const* vec = rows.read(row, buffer.data());
+                if (!finite(vec)) {
+                    continue;
+                }
+                double dot = 0;
+                for (size_t i = 0; i < _dim; i++) {
+                    dot += (vec[i] - mean[i]) * axis[i];
+                }
+                for (size_t i = 0; i < _dim; i++) {
+                    next[i] += dot * (vec[i] - mean[i]);
+                }
+            }
+            double length = 0;
+            for (double cord : next) {
+                length += cord * cord;
+            }
+            length = std::sqrt(length);
+            if (!(length > 0) || !std::isfinite(length)) {
+                fitted = false;
+                break;
+            }
+            double change = 0;
+            for (size_t i = 0; i < _dim; i++) {
+                next[i] /= length;
+                change += std::fabs(next[i] - axis[i]);
+            }
+            axis.swap(next);
+            fitted = true;
+            if (change < axisPrecision) {
+                break;
+            }
+        }
+    }
+    if (fitted) {
+        double length = 0;
+        for (double cord : axis) {
+            length += std::fabs(cord);
+        }
+        for (size_t i = 0; i < _dim; i++) {
+            _axis[i] = axis[i] / length;
+        }
+    }
+
+    _sorted.clear();
+    _tail.clear();
+    _unordered.clear();
+    _alive = 0;
+    _dead = 0;
+    _magnitude = 0;
+    for (size_t row : live) {
+        add(entryOf(rows, row));
+    }
+    merge();
+    _fitted = _alive;
+}
+
+void SortedIndex::grown(Rows const& rows) {
+    if (_alive >= minTail && _alive > 2 * _fitted) {
+        std::vector<size_t> live;
+        live.reserve(_alive);
+        for (std::vector<Entry> const* entries : { &_sorted, &_tail, &_unordered }) {
+            for (Entry const& entry : *entries) {
+                if (entry.row != npos) {
+                    live.push_back(entry.row);
+                }
+            }
+        }
+        refit(rows, live);
+    } else if (_tail.size() > std::max(minTail, (size_t)std::sqrt((double)_sorted.size()))) {
+        merge();
+    }
+}
+
+RC SortedIndex::insert(Rows const& rows, size_t row, double) {
+    add(entryOf(rows, row));
+    grown(rows);
+    return RC::SUCCESS;
+}
+
+RC SortedIndex::append(Rows const& rows, size_t from, size_t to, double) {
+    for (size_t row = from; row < to; row++) {
+        add(entryOf(rows, row));
+    }
+    grown(rows);
+    return RC::SUCCESS;
+}
+
+SortedIndex::Entry* SortedIndex::find(Rows const& rows, size_t row) {
+    Entry probe = entryOf(rows, row);
+    auto same = [row](Entry const& entry) { return entry.row == row; };
+    if (std::isnan(probe.key)) {
+        auto it = std::find_if(_unordered.begin(), _unordered.end(), same);
+        return it == _unordered.end() ? nullptr : &*it;
+    }
+    // the key is computed the same way as when the row was added, so it compares equal
+    auto range = std::equal_range(_sorted.begin(), _sorted.end(), probe, [](Entry const& a, Entry const& b) { return a.key < b.key; });
+    auto it = std::find_if(range.first, range.second, same);
+    if (it != range.second) {
+        return &*it;
+    }
+    it = std::find_if(_tail.begin(), _tail.end(), same);
+    return it == _tail.end() ? nullptr : &*it;
+}
+
+RC SortedIndex::remove(Rows const& rows, size_t row) {
+    Entry* entry = find(rows, row);
+    if (!entry) {
+        return RC::VECTOR_NOT_FOUND;
+    }
+    _alive--;
+    if (entry >= _sorted.data() && entry < _sorted.data() + _sorted.size()) {
+        entry->row = npos;
+        _dead++;
+        if (2 * _dead > _sorted.size()) {
+            merge();
+        }
+        return RC::SUCCESS;
+    }
+    // tail and unordered entries are kept in no particular order
+    std::vector<Entry>& entries = std::isnan(entry->key) ? _unordered : _tail;
+    *entry = entries.back();
+    entries.pop_back();
+    return RC::SUCCESS;
+}
+
+void SortedIndex::shift(size_t row) {
+    for (std::vector<Entry>* entries : { &_sorted, &_tail, &_unordered }) {
+        for (Entry& entry : *entries) {
+            if (entry.row != npos && entry.row > row) {
+                entry.row--;
+            }
+        }
+    }
+}
+
+RC SortedIndex::move(Rows const& rows, size_t from, size_t to) {
+    Entry* entry = find(rows, from);
+    if (!entry) {
+        return RC::VECTOR_NOT_FOUND;
+    }
+    entry->row = to;
+    return RC::SUCCESS;
+}
+
+void SortedIndex::clear() {
+    _sorted.clear();
+    _tail.clear();
+    _unordered.clear();
+    _alive = 0;
+    _dead = 0;
+    _fitted = 0;
+    _magnitude = 0;
+}
+
+bool SortedIndex::near(Entry const& entry, double const* pat, double tol) const {
+    // NaN differences are left to the exact check
+    for (size_t i = 0; i < std::min(_dim, storedAxes); i++) {
+        if (std::fabs(pat[i] - entry.cords[i]) >= tol) {
+            return false;
+        }
+    }
+    return true;
+}
+
+void SortedIndex::query(Rows const&, double const* pat, double tol, const Visitor& visit) const {
+    if (!(tol > 0)) {
+        return;
+    }
+    auto sweep = [&](Entry const* entry, Entry const* end) {
+        for (; entry != end; entry++) {
+            if (entry->row != npos && near(*entry, pat, tol) && !visit(entry->row)) {
+                return false;
+            }
+        }
+        return true;
+    };
+    if (!sweep(_unordered.data(), _unordered.data() + _unordered.size()) || !sweep(_tail.data(), _tail.data() + _tail.size())) {
+        return;
+    }
+    double key = keyOf(pat);
+    if (std::isnan(key)) {
+        return;
+    }
+    // projections are rounded, each by up to about dim ulps of the largest coordinate
+    double magnitude = _magnitude;
+    for (size_t i = 0; i < _dim; i++) {
+        if (std::isfinite(pat[i])) {
+            magnitude = std::max(magnitude, std::fabs(pat[i]));
+        }
+    }
+    double width = tol * (1 + 4 * DBL_EPSILON) + 4 * (double)_dim * DBL_EPSILON * magnitude;
+    Entry const* first = std::lower_bound(_sorted.data(), _sorted.data() + _sorted.size(), key - width,
+        [](Entry const& entry, double bound) { return entry.key < bound; });
+    Entry const* last = std::upper_bound(first, _sorted.data() + _sorted.size(), key + width,
+        [](double bound, Entry const& entry) { return bound < entry.key; });
+    sweep(first, last);
+}
+
+RC SortedIndex::rebuild(Rows const& rows, size_t size) {
+    std::vector<size_t> live(size);
+    for (size_t i = 0; i < size; i++) {
+        live[i] = i;
+    }
+    refit(rows, live);
+    return RC::SUCCESS;
+}
+
+size_t SortedIndex::sizeAllocated() const {
+    return sizeof(SortedIndex) + _axis.capacity() * sizeof(double)
+        + (_sorted.capacity() + _tail.capacity() + _unordered.capacity()) * sizeof(Entry);
+}
+
+void SortedIndex::shrinkToFit(Rows const&) {
+    merge();
+    _sorted.shrink_to_fit();
+    _tail.shrink_to_fit();
+    _unordered.shrink_to_fit();
+}
@@ -0,0 +1,243 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <unordered_map>
+#include <vector>
+#include "../include/ISet.h"
+#include "Rows.h"
+
+/*
+* Tolerance-aware spatial index over the rows of a Set
+*
+* The index stores row numbers only, coordinates are always read from the Set rows passed to every call,
+* so the storage may be reallocated freely between calls
+*
+* query() reports candidate rows, the caller has to verify the exact distance
+*/
+class SetIndex {
+public:
+    /*
+    * Callback receives a candidate row, returning false stops the search
+    */
+    using Visitor = std::function<bool(size_t row)>;
+
+    static SetIndex* createIndex(ISet::INDEX type, size_t dim);
+
+    virtual ISet::INDEX getType() const = 0;
+
+    /*
+    * Row `row` has already been written to `rows`, `tol` is the tolerance used by the inserting call
+    */
+    virtual RC insert(Rows const& rows, size_t row, double tol) = 0;
+
+    /*
+    * Rows [from, to) have been written to `rows` at once, inserted one by one unless the index has a faster way
+    */
+    virtual RC append(Rows const& rows, size_t from, size_t to, double tol);
+
+    /*
+    * Must be called before the row is overwritten in `rows`, other rows keep their numbers
+    */
+    virtual RC remove(Rows const& rows, size_t row) = 0;
+
+    /*
+    * Rows after `row` are renumbered down by one, as the Set shifts its tail over a removed row
+    */
+    virtual void shift(size_t row) = 0;
+
+    /*
+    * Row `from` is relabelled as `to`, must be called while `from` is still in place in `rows`
+    */
+    virtual RC move(Rows const& rows, size_t from, size_t to) = 0;
+
+    virtual void clear() = 0;
+
+    /*
+    * Reports every row that may lie closer than `tol` to `pat` in any of the supported norms
+    */
+    virtual void query(Rows const& rows, double const* pat, double tol, const Visitor& visit) const = 0;
+
+    /*
+    * Indexes rows [0, size) from scratch
+    */
+    virtual RC rebuild(Rows const& rows, size_t size);
+
+    /*
+    * Approximate heap memory held by the index
+    */
+    virtual size_t sizeAllocated() const = 0;
+    virtual void shrinkToFit(Rows const& rows) = 0;
+
+    /*
+    * Flat image of the index for ISet::save(), imageSize() is 0 for indices that are rebuilt from the rows on load
+    */
+    virtual size_t imageSize() const;
+    virtual void writeImage(char* image) const;
+
+    /*
+    * Replaces the index with an image written by writeImage() over rows [0, size), false if the image is malformed
+    */
+    virtual bool readImage(char const* image, size_t bytes, size_t size);
+
+    virtual ~SetIndex() = default;
+
+protected:
+    SetIndex(size_t dim) : _dim(dim) {}
+
+    size_t _dim;
+};
+
+/*
+* Uniform grid hashed over the leading coordinates
+*
+* Cell edge is fixed by the first tolerance passed to insert(), rows inserted before that are kept unhashed
+* The edge survives clear(), so a rebuilt grid hashes right away
+* Any per-coordinate difference is a lower bound of CHEBYSHEV, FIRST and SECOND norms,
+* so probing neighbouring cells of the projection never loses a match
+*/
+class GridIndex : public SetIndex {
+public:
+    GridIndex(size_t dim);
+
+    virtual ISet::INDEX getType() const override;
+    virtual RC insert(Rows const& rows, size_t row, double tol) override;
+    virtual RC remove(Rows const& rows, size_t row) override;
+    virtual void shift(size_t row) override;
+    virtual RC move(Rows const& rows, size_t from, size_t to) override;
+    virtual void clear() override;
+    virtual void query(Rows const& rows, double const* pat, double tol, const Visitor& visit) const override;
+    virtual size_t sizeAllocated() const override;
+    virtual void shrinkToFit(Rows const& rows) override;
+
+private:
+    static constexpr size_t maxHashedAxes = 3;
+    static constexpr long long maxProbeRadius = 2;
+
+    struct Key {
+        long long cells[maxHashedAxes];
+        bool operator==(const Key& other) const;
+    };
+
+    struct KeyHash {
+        size_t operator()(const Key& key) const;
+    };
+
+    size_t _axes;
+    double _cell;
+    std::vector<size_t> _pending;
+    std::unordered_map<Key, std::vector<size_t>, KeyHash> _cells;
+
+    long long cellOf(double cord) const;
+    Key keyOf(double const* vec) const;
+    Key keyOf(Rows const& rows, size_t row) const;
+    std::vector<size_t>* rowsOf(Rows const& rows, size_t row);
+};
+
+/*
+* Dynamic k-d tree, splitting axes cyclically with depth
+*
+* Removed rows are left as tombstones and the tree is rebuilt balanced once they or the depth grow too large
+*/
+class KdTreeIndex : public SetIndex {
+public:
+    KdTreeIndex(size_t dim);
+
+    virtual ISet::INDEX getType() const override;
+    virtual RC insert(Rows const& rows, size_t row, double tol) override;
+    virtual RC remove(Rows const& rows, size_t row) override;
+    virtual void shift(size_t row) override;
+    virtual RC move(Rows const& rows, size_t from, size_t to) override;
+    virtual void clear() override;
+    virtual void query(Rows const& rows, double const* pat, double tol, const Visitor& visit) const override;
+    virtual RC rebuild(Rows const& rows, size_t size) override;
+    virtual RC append(Rows const& rows, size_t from, size_t to, double tol) override;
+    virtual size_t sizeAllocated() const override;
+    virtual void shrinkToFit(Rows const& rows) override;
+    virtual size_t imageSize() const override;
+    virtual void writeImage(char* image) const override;
+    virtual bool readImage(char const* image, size_t bytes, size_t size) override;
+
+private:
+    static constexpr size_t npos = (size_t)-1;
+
+    struct Node {
+        size_t row;
+        double split;
+        size_t left;
+        size_t right;
+    };
+
+    std::vector<Node> _nodes;
+    size_t _root;
+    size_t _alive;
+    size_t _sinceRebuild;
+
+    size_t build(Rows const& rows, std::vector<size_t>& order, size_t from, size_t to, size_t depth);
+    void compact(Rows const& rows);
+    size_t find(Rows const& rows, size_t row) const;
+};
+
+/*
+* Rows sorted by their projection on the principal axis of the indexed rows, kept in one contiguous array
+*
+* The axis is scaled to unit FIRST norm, so projections of two rows differ by at most their CHEBYSHEV distance,
+* which bounds all supported norms from below: a query binary-searches the window of projections within tol of
+* the pattern's and sweeps it. Entries carry the leading coordinates, so the sweep rejects most rows without
+* reading the Set storage, and 2D and 3D point clouds are scanned as one run of memory. The window holds a share
+* of all rows, so past about 10^4 rows a k-d tree answers faster
+* Inserted rows wait in a short unsorted tail until it's merged, the axis is fitted again whenever the row
+* count doubles
+*/
+class SortedIndex : public SetIndex {
+public:
+    SortedIndex(size_t dim);
+
+    virtual ISet::INDEX getType() const override;
+    virtual RC insert(Rows const& rows, size_t row, double tol) override;
+    virtual RC append(Rows const& rows, size_t from, size_t to, double tol) override;
+    virtual RC remove(Rows const& rows, size_t row) override;
+    virtual void shift(size_t row) override;
+    virtual RC move(Rows const& rows, size_t from, size_t to) override;
+    virtual void clear() override;
+    virtual void query(Rows const& rows, double const* pat, double tol, const Visitor& visit) const override;
+    virtual RC rebuild(Rows const& rows, size_t size) override;
+    virtual size_t sizeAllocated() const override;
+    virtual void shrinkToFit(Rows const& rows) override;
+
+private:
+    static constexpr size_t npos = (size_t)-1;
+    static constexpr size_t storedAxes = 3;
+    static constexpr size_t minTail = 64;
+
+    struct Entry {
+        double key;
+        double cords[storedAxes];
+        size_t row;  // npos once removed
+    };
+
+    std::vector<double> _axis;
+    std::vector<Entry> _sorted;
+    std::vector<Entry> _tail;
+    // rows projected to NaN, swept by every query
+    std::vector<Entry> _unordered;
+    size_t _alive;
+    // removed entries still in _sorted
+    size_t _dead;
+    size_t _fitted;
+    // largest finite coordinate magnitude indexed, bounds rounding of projections
+    double _magnitude;
+
+    double keyOf(double const* vec) const;
+
+    /*
+    * Entry of a row in place, widens _magnitude
+    */
+    Entry entryOf(Rows const& rows, size_t row);
+    void add(Entry const& entry);
+    void grown(Rows const& rows);
+    void merge();
+    void refit(Rows const& rows, std::vector<size_t> const& live);
+    Entry* find(Rows const& rows, size_t row);
+    bool near(Entry const& entry, double const* pat, double tol) const;
+};
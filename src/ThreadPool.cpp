@@ -0,0 +1,93 @@
+#include <algorithm>
+#include "ThreadPool.h"
+
+static thread_local bool insideLoop = false;
+
+ThreadPool::ThreadPool(size_t threads) {
+    if (threads == 0) {
+        threads = std::max(1u, std::thread::hardware_concurrency());
+    }
+    _body = nullptr;
+    _count = 0;
+    _grain = 1;
+    _next = 0;
+    _busy = 0;
+    _generation = 0;
+    _stop = false;
+    for (size_t i = 1; i < threads; i++) {
+        _workers.emplace_back(&ThreadPool::work, this);
+    }
+}
+
+size_t ThreadPool::getThreadCount() const {
+    return _workers.size() + 1;
+}
+
+void ThreadPool::runChunks() {
+    insideLoop = true;
+    size_t chunk;
+    while ((chunk = _next.fetch_add(1)) * _grain < _count) {
+        size_t begin = chunk * _grain;
+        (*_body)(begin, std::min(begin + _grain, _count));
+    }
+    insideLoop = false;
+}
+
+void ThreadPool::work() {
+    size_t seen = 0;
+    std::unique_lock<std::mutex> lock(_mutex);
+    while (true) {
+        _wake.wait(lock, [&] { return _stop || _generation != seen; });
+        if (_stop) {
+            return;
+        }
+        seen = _generation;
+        lock.unlock();
+        runChunks();
+        lock.lock();
+        if (--_busy == 0) {
+            _done.notify_one();
+        }
+    }
+}
+
+void ThreadPool::parallelFor(size_t count, size_t grain, const Body& body) {
+    if (grain == 0) {
+        grain = 1;
+    }
+    // a loop of another thread holding the workers isn't waited for, the caller runs its own loop alone
+    std::unique_lock<std::mutex> loop(_loopMutex, std::defer_lock);
+    if (insideLoop || _workers.empty() || count <= grain || !loop.try_lock()) {
+        for (size_t begin = 0; begin < count; begin += grain) {
+            body(begin, std::min(begin + grain, count));
+        }
+        return;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        _body = &body;
+        _count = count;
+        _grain = grain;
+        _next = 0;
+        _busy = _workers.size();
+        _generation++;
+    }
+    _wake.notify_all();
+    runChunks();
+
+    std::unique_lock<std::mutex> lock(_mutex);
+    _done.wait(lock, [&] { return _busy == 0; });
+    _body = nullptr;
+}
+
+ThreadPool::~ThreadPool() {
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        _stop = true;
+    }
+    _wake.notify_all();
+    for (std::thread& worker : _workers) {
+        worker.join();
+    }
+}
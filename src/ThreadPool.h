@@ -0,0 +1,57 @@
+#pragma once
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+/*
+* Fixed set of worker threads running parallel loops
+*
+* A loop is cut into chunks of `grain` iterations, every thread (the caller included) keeps claiming
+* the next unprocessed chunk until none is left, so fast threads take over the work of slow ones
+*/
+class ThreadPool {
+public:
+    using Body = std::function<void(size_t begin, size_t end)>;
+
+    /*
+    * @param [in] threads Total number of threads running a loop including the caller,
+    * 0 means std::thread::hardware_concurrency()
+    */
+    ThreadPool(size_t threads);
+
+    size_t getThreadCount() const;
+
+    /*
+    * Runs body over [0, count) and returns once every chunk is processed
+    * Calls made from inside a running loop, or while another thread's loop runs, are executed serially by the
+    * calling thread, so a call never waits for other loops
+    */
+    void parallelFor(size_t count, size_t grain, const Body& body);
+
+    ~ThreadPool();
+
+private:
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+
+    void work();
+    void runChunks();
+
+    std::vector<std::thread> _workers;
+    std::mutex _loopMutex;
+    std::mutex _mutex;
+    std::condition_variable _wake;
+    std::condition_variable _done;
+
+    Body const* _body;
+    size_t _count;
+    size_t _grain;
+    std::atomic<size_t> _next;
+    size_t _busy;
+    size_t _generation;
+    bool _stop;
+};
@@ -0,0 +1,90 @@
+#include "Tombstones.h"
+
+static inline size_t lowbit(size_t i) {
+    return i & (~i + 1);
+}
+
+Tombstones::Tombstones() {
+    _count = 0;
+}
+
+size_t Tombstones::count() const {
+    return _count;
+}
+
+bool Tombstones::isDead(size_t row) const {
+    return _count != 0 && _dead[row];
+}
+
+void Tombstones::kill(size_t row, size_t rows) {
+    if (_count == 0) {
+        _dead.assign(rows, 0);
+        _tree.assign(rows + 1, 0);
+    }
+    if (_dead[row]) {
+        return;
+    }
+    _dead[row] = 1;
+    _count++;
+    for (size_t i = row + 1; i < _tree.size(); i += lowbit(i)) {
+        _tree[i]++;
+    }
+}
+
+void Tombstones::append() {
+    if (_count == 0) {
+        return;
+    }
+    // node i covers rows (i - lowbit(i), i], the new row itself is alive
+    size_t i = _tree.size();
+    _dead.push_back(0);
+    _tree.push_back(prefix(i - 1) - prefix(i - lowbit(i)));
+}
+
+size_t Tombstones::prefix(size_t rows) const {
+    size_t res = 0;
+    for (size_t i = rows; i > 0; i -= lowbit(i)) {
+        res += _tree[i];
+    }
+    return res;
+}
+
+size_t Tombstones::physical(size_t logical) const {
+    if (_count == 0) {
+        return logical;
+    }
+    size_t rows = _dead.size();
+    size_t step = 1;
+    while (2 * step <= rows) {
+        step *= 2;
+    }
+    // descend to the last position having at most `logical` live rows before it
+    size_t pos = 0;
+    size_t left = logical + 1;
+    for (; step > 0; step /= 2) {
+        if (pos + step <= rows && step - _tree[pos + step] < left) {
+            pos += step;
+            left -= step - _tree[pos];
+        }
+    }
+    return pos;
+}
+
+size_t Tombstones::logical(size_t physical) const {
+    if (_count == 0) {
+        return physical;
+    }
+    return physical - prefix(physical);
+}
+
+void Tombstones::clear() {
+    _dead.clear();
+    _tree.clear();
+    _dead.shrink_to_fit();
+    _tree.shrink_to_fit();
+    _count = 0;
+}
+
+size_t Tombstones::sizeAllocated() const {
+    return _dead.capacity() * sizeof(char) + _tree.capacity() * sizeof(size_t);
+}
@@ -0,0 +1,40 @@
+#pragma once
+#include <cstddef>
+#include <vector>
+
+/*
+* Rows of a Set marked as removed but not yet compacted away
+*
+* Removed rows are counted in a Fenwick tree, so translating between logical indices (as seen through ISet)
+* and physical rows takes O(log n). Nothing is tracked until the first row is killed
+*/
+class Tombstones {
+public:
+    Tombstones();
+
+    size_t count() const;
+    bool isDead(size_t row) const;
+
+    /*
+    * @param [in] rows Current number of physical rows
+    */
+    void kill(size_t row, size_t rows);
+
+    /*
+    * A live row has been appended
+    */
+    void append();
+
+    size_t physical(size_t logical) const;
+    size_t logical(size_t physical) const;
+
+    void clear();
+    size_t sizeAllocated() const;
+
+private:
+    size_t prefix(size_t rows) const;
+
+    std::vector<char> _dead;
+    std::vector<size_t> _tree;
+    size_t _count;
+};
@@ -3,38 +3,81 @@
 #include <cmath>
 #include <stdint.h>
 #include <limits>
+#include <vector>
 #include "Vector.h"
+#include "Counters.h"
+#include "Kernels.h"
+#include "../include/IVectorView.h"
 
 using namespace std;
 
-ILogger* Vector::_logger = nullptr;
+std::atomic<ILogger*> Vector::_logger(nullptr);
+static thread_local IAllocator* threadAllocator = nullptr;
+static thread_local ILogger* threadLogger = nullptr;
 
-Vector* Vector::createVector(size_t dim, double const* const& pData) {
-    size_t size = sizeof(Vector) + dim * sizeof(double);
-    void* mem = malloc(size);
-    if (!mem) {
-        return nullptr;
+#ifdef COLLECT_STATS
+// never destroyed, vectors may still be created while static objects are
+static Counters& counters() {
+    static Counters* res = new Counters();
+    return *res;
+}
+
+static void dumpStats() {
+    if (!counters().takeDump()) {
+        return;
+    }
+    ILogger* logger = Vector::getLogger();
+    IVector::Stats stats;
+    if (!logger || IVector::getStats(stats) != RC::SUCCESS) {
+        return;
     }
-    Vector* vector = new (mem) Vector(dim);
-    double* vecData = (double*)vector->getData();
-    for (size_t i = 0; i < dim; i++) {
+    char text[128];
+    snprintf(text, sizeof(text), "Vector stats: %zu allocations, %zu bytes allocated", stats.allocations, stats.bytesAllocated);
+    logger->logText(ILogger::Level::INFO, text);
+}
+#endif
+
+Vector* Vector::createVector(size_t dim, double const* const& pData, IAllocator* allocator) {
 #ifndef FAST_MATH
-        if (isnan(pData[i]) || isinf(pData[i])) {
-            free(mem);
-            return nullptr;
-        }
+    if (!kernels::isFinite(pData, dim)) {
+        return nullptr;
+    }
 #endif
-        vecData[i] = pData[i];
+    size_t size = sizeof(Header) + sizeof(Vector) + dim * sizeof(double);
+    void* mem = allocator ? allocator->allocate(size) : malloc(size);
+    if (!mem) {
+        return nullptr;
     }
+    Header* header = new (mem) Header{ allocator, size };
+    Vector* vector = new (header + 1) Vector(dim);
+    memcpy(vector->getDataArray(), pData, dim * sizeof(double));
+    COUNT_STAT(counters(), ALLOCATIONS, 1);
+    COUNT_STAT(counters(), BYTES_ALLOCATED, size);
+#ifdef COLLECT_STATS
+    dumpStats();
+#endif
     return vector;
 }
 
+void Vector::operator delete(void* ptr) {
+    Header* header = (Header*)ptr - 1;
+    if (header->allocator) {
+        header->allocator->deallocate(header, header->size);
+    } else {
+        free(header);
+    }
+}
+
+inline Vector::Header* Vector::getHeader() const {
+    return (Header*)this - 1;
+}
+
 inline double* Vector::getDataArray() {
     return (double*)((uint8_t*)this + sizeof(Vector));
 }
 
 IVector* Vector::clone() const {
-    return Vector::createVector(_dim, getData());
+    return Vector::createVector(_dim, getData(), getHeader()->allocator);
 }
 
 double const* Vector::getData() const {
@@ -42,10 +85,14 @@ double const* Vector::getData() const {
 }
 
 RC Vector::setLogger(ILogger* const logger) {
-    Vector::_logger = logger;
+    Vector::_logger.store(logger, std::memory_order_relaxed);
     return RC::SUCCESS;
 }
 
+ILogger* Vector::getLogger() {
+    return threadLogger ? threadLogger : _logger.load(std::memory_order_relaxed);
+}
+
 RC Vector::getCord(size_t index, double& val) const {
 #ifndef FAST_MATH
     if (index >= _dim) {
@@ -59,15 +106,11 @@ RC Vector::getCord(size_t index, double& val) const {
 RC Vector::setCord(size_t index, double val) {
 #ifndef FAST_MATH
     if (index >= _dim) {
-        if (_logger) {
-            _logger->warning(RC::INDEX_OUT_OF_BOUND);
-        }
+        SendWarning(getLogger(), RC::INDEX_OUT_OF_BOUND);
         return RC::INDEX_OUT_OF_BOUND;
     }
     if (isnan(val) || isinf(val)) {
-        if (_logger) {
-            _logger->warning(RC::INVALID_ARGUMENT);
-        }
+        SendWarning(getLogger(), RC::INVALID_ARGUMENT);
         return RC::INVALID_ARGUMENT;
     }
 #endif
@@ -76,28 +119,18 @@ RC Vector::setCord(size_t index, double val) {
 }
 
 RC Vector::scale(double multiplier) {
+    double* data = getDataArray();
 #ifndef FAST_MATH
-    double buf;
     if (isnan(multiplier) || isinf(multiplier)) {
-        if (_logger) {
-            _logger->warning(RC::INVALID_ARGUMENT);
-        }
+        SendWarning(getLogger(), RC::INVALID_ARGUMENT);
         return RC::INVALID_ARGUMENT;
     }
-#endif
-    double* data = (double*)getData();
-    
-    for (size_t i = 0; i < _dim; i++) {
-#ifdef FAST_MATH
-        data[i] *= multiplier;
-#else
-        buf = data[i] * multiplier;
-        if (isinf(buf)) {
-            return RC::INVALID_ARGUMENT;
-        }
-        data[i] = buf;
-#endif
+    // the largest product overflows iff any does, so the vector is left untouched on failure
+    if (isinf(kernels::maxAbs(data, _dim) * fabs(multiplier))) {
+        return RC::INVALID_ARGUMENT;
     }
+#endif
+    kernels::scale(data, multiplier, _dim);
     return RC::SUCCESS;
 }
 
@@ -108,69 +141,34 @@ size_t Vector::getDim() const {
 RC Vector::inc(IVector const* const& op) {
 #ifndef FAST_MATH
     if (_dim != op->getDim()) {
-        if (_logger) {
-            _logger->warning(RC::MISMATCHING_DIMENSIONS);
-        }
+        SendWarning(getLogger(), RC::MISMATCHING_DIMENSIONS);
         return RC::MISMATCHING_DIMENSIONS;
     }
 #endif
-    double* data = (double*)getData();
-    const double* opData = op->getData();
-    for (size_t i = 0; i < _dim; i++) {
-        data[i] += opData[i];
-    }
+    kernels::inc(getDataArray(), op->getData(), _dim);
     return RC::SUCCESS;
 }
 
 RC Vector::dec(IVector const* const& op) {
 #ifndef FAST_MATH
     if (_dim != op->getDim()) {
-        if (_logger) {
-            _logger->warning(RC::MISMATCHING_DIMENSIONS);
-        }
+        SendWarning(getLogger(), RC::MISMATCHING_DIMENSIONS);
         return RC::MISMATCHING_DIMENSIONS;
     }
 #endif
-    double* data = getDataArray();
-    const double* opData = op->getData();
-    for (size_t i = 0; i < _dim; i++) {
-        data[i] -= opData[i];
-    }
+    kernels::dec(getDataArray(), op->getData(), _dim);
     return RC::SUCCESS;
 }
 
 double Vector::norm(NORM n) const {
-    double res = 0;
-    const double* data = getData();
-    switch (n) {
-    case NORM::FIRST:
-        for (size_t i = 0; i < _dim; i++) {
-            res += fabs(data[i]);
-        }
-        break;
-    case NORM::SECOND:
-        for (size_t i = 0; i < _dim; i++) {
-            res += pow(data[i], 2);
-        }
-        res = sqrt(res);
-        break;
-    case NORM::CHEBYSHEV:
-        res = 0;
-        for (size_t i = 0; i < _dim; i++) {
-            res = fmax(res, fabs(data[i]));
-        }
-        break;
-    default:
-        if (_logger) {
-            _logger->warning(RC::INVALID_ARGUMENT);
-        }
+    if (n >= NORM::AMOUNT) {
+        SendWarning(getLogger(), RC::INVALID_ARGUMENT);
         return NAN;
     }
+    double res = kernels::norm(getData(), _dim, n);
 #ifndef FAST_MATH
     if (isinf(res)) {
-        if (_logger) {
-            _logger->warning(RC::INFINITY_OVERFLOW);
-        }
+        SendWarning(getLogger(), RC::INFINITY_OVERFLOW);
         return NAN;
     }
 #endif
@@ -184,9 +182,7 @@ RC Vector::applyFunction(const std::function<double(double)>& fun) {
         funcRes = fun(data[i]);
 #ifndef FAST_MATH
         if (isnan(funcRes) || isinf(funcRes)) {
-            if (_logger) {
-                _logger->warning(RC::INVALID_ARGUMENT);
-            }
+            SendWarning(getLogger(), RC::INVALID_ARGUMENT);
             return RC::INVALID_ARGUMENT;
         }
 #endif
@@ -216,7 +212,50 @@ Vector::Vector(size_t dim) {
 }
 
 IVector* IVector::createVector(size_t dim, double const* const& ptr_data) {
-    return (IVector*)Vector::createVector(dim, ptr_data);
+    return (IVector*)Vector::createVector(dim, ptr_data, threadAllocator);
+}
+
+IVector* IVector::createVector(size_t dim, double const* const& ptr_data, IAllocator* allocator) {
+    return (IVector*)Vector::createVector(dim, ptr_data, allocator);
+}
+
+RC IVector::setThreadAllocator(IAllocator* allocator) {
+    threadAllocator = allocator;
+    return RC::SUCCESS;
+}
+
+IAllocator* IVector::getThreadAllocator() {
+    return threadAllocator;
+}
+
+RC IVector::getStats(Stats& stats) {
+#ifdef COLLECT_STATS
+    stats.allocations = (size_t)counters().get(Counters::Counter::ALLOCATIONS);
+    stats.bytesAllocated = (size_t)counters().get(Counters::Counter::BYTES_ALLOCATED);
+    return RC::SUCCESS;
+#else
+    stats = {};
+    return RC::NOT_SUPPORTED;
+#endif
+}
+
+RC IVector::resetStats() {
+#ifdef COLLECT_STATS
+    counters().reset();
+    return RC::SUCCESS;
+#else
+    return RC::NOT_SUPPORTED;
+#endif
+}
+
+RC IVector::setStatsDump(size_t milliseconds) {
+#ifdef COLLECT_STATS
+    counters().setDumpPeriod(milliseconds);
+    return RC::SUCCESS;
+#else
+    (void)milliseconds;
+    return RC::NOT_SUPPORTED;
+#endif
 }
 
 RC IVector::copyInstance(IVector* const dest, IVector const* const& src) {
@@ -243,13 +282,19 @@ RC IVector::setLogger(ILogger* const logger) {
     return Vector::setLogger(logger);
 }
 
+RC IVector::setThreadLogger(ILogger* const logger) {
+    threadLogger = logger;
+    return RC::SUCCESS;
+}
+
+ILogger* IVector::getThreadLogger() {
+    return threadLogger;
+}
+
 IVector* IVector::add(IVector const* const& op1, IVector const* const& op2) {
 #ifndef FAST_MATH
     if (op1->getDim() != op2->getDim()) {
-        // we need to update the interface to use logger here 
-        /* if (_logger) {
-            _logger->warning(RC::MISMATCHING_DIMENSIONS);
-        } */
+        SendWarning(Vector::getLogger(), RC::MISMATCHING_DIMENSIONS);
         return nullptr;
     }
 #endif
@@ -264,10 +309,7 @@ IVector* IVector::add(IVector const* const& op1, IVector const* const& op2) {
 IVector* IVector::sub(IVector const* const& op1, IVector const* const& op2) {
 #ifndef FAST_MATH
     if (op1->getDim() != op2->getDim()) {
-        // we need to update the interface to use logger here 
-        /* if (_logger) {
-            _logger->warning(RC::MISMATCHING_DIMENSIONS);
-        } */
+        SendWarning(Vector::getLogger(), RC::MISMATCHING_DIMENSIONS);
         return nullptr;
     }
 #endif
@@ -276,11 +318,7 @@ IVector* IVector::sub(IVector const* const& op1, IVector const* const& op2) {
     if (!res) {
         return nullptr;
     }
-    double* data = (double*)res->getData();
-    const double* opData = op2->getData();
-    for (size_t i = 0; i < dim; i++) {
-        data[i] -= opData[i];
-    }
+    kernels::dec((double*)res->getData(), op2->getData(), dim);
     return res;
 
 }
@@ -288,26 +326,14 @@ IVector* IVector::sub(IVector const* const& op1, IVector const* const& op2) {
 double IVector::dot(IVector const* const& op1, IVector const* const& op2) {
 #ifndef FAST_MATH
     if (op1->getDim() != op2->getDim()) {
-        // we need to update the interface to use logger here 
-        /* if (_logger) {
-            _logger->warning(RC::MISMATCHING_DIMENSIONS);
-        } */
+        SendWarning(Vector::getLogger(), RC::MISMATCHING_DIMENSIONS);
         return NAN;
     }
 #endif
-    size_t dim = op1->getDim();
-    double res = 0;
-    const double* data1 = op1->getData();
-    const double* data2 = op2->getData();
-    for (size_t i = 0; i < dim; i++) {
-        res += data1[i] * data2[i];
-    }
+    double res = kernels::dot(op1->getData(), op2->getData(), op1->getDim());
 #ifndef FAST_MATH
     if (isinf(res)) {
-        // we need to update the interface to use logger here 
-        /* if (_logger) {
-            _logger->warning(RC::INFINITY_OVERFLOW);
-        } */
+        SendWarning(Vector::getLogger(), RC::INFINITY_OVERFLOW);
         return NAN;
     }
 #endif
@@ -315,30 +341,196 @@ double IVector::dot(IVector const* const& op1, IVector const* const& op2) {
 }
 
 bool IVector::equals(IVector const* const& op1, IVector const* const& op2, NORM n, double tol) {
-    IVector* diff = op1->clone();
+    return equals(IVectorView(op1), IVectorView(op2), n, tol);
+}
+
+// every operand of the in-place operations has the destination's dimension
+static bool sameDim(IVector const* dest, IVector const* op1, IVector const* op2) {
+    return dest->getDim() == op1->getDim() && dest->getDim() == op2->getDim();
+}
+
+RC IVector::add(IVector* const dest, IVector const* const& op1, IVector const* const& op2) {
 #ifndef FAST_MATH
-    if (!diff) {
-        // we need to update the interface to use logger here 
-        /* if (_logger) {
-            _logger->warning(RC::ALLOCATION_ERROR);
-        } */
-        return false;
+    if (!sameDim(dest, op1, op2)) {
+        SendWarning(Vector::getLogger(), RC::MISMATCHING_DIMENSIONS);
+        return RC::MISMATCHING_DIMENSIONS;
     }
 #endif
-    diff->dec(op2);
-    double diffNorm = diff->norm(n);
+    kernels::add((double*)dest->getData(), op1->getData(), op2->getData(), dest->getDim());
+    return RC::SUCCESS;
+}
+
+RC IVector::sub(IVector* const dest, IVector const* const& op1, IVector const* const& op2) {
 #ifndef FAST_MATH
-    if (isnan(diffNorm)) {
-        delete diff;
-        // we need to update the interface to use logger here 
-        /* if (_logger) {
-            _logger->warning(RC::NOT_NUMBER);
-        } */
-        return false;
+    if (!sameDim(dest, op1, op2)) {
+        SendWarning(Vector::getLogger(), RC::MISMATCHING_DIMENSIONS);
+        return RC::MISMATCHING_DIMENSIONS;
     }
 #endif
-    delete diff;
-    return diffNorm < tol;
+    kernels::sub((double*)dest->getData(), op1->getData(), op2->getData(), dest->getDim());
+    return RC::SUCCESS;
+}
+
+RC IVector::axpy(double alpha, IVector const* const& x, IVector* const y) {
+#ifndef FAST_MATH
+    if (x->getDim() != y->getDim()) {
+        SendWarning(Vector::getLogger(), RC::MISMATCHING_DIMENSIONS);
+        return RC::MISMATCHING_DIMENSIONS;
+    }
+    if (isnan(alpha) || isinf(alpha)) {
+        SendWarning(Vector::getLogger(), RC::INVALID_ARGUMENT);
+        return RC::INVALID_ARGUMENT;
+    }
+    size_t dim = y->getDim();
+    // y is left untouched on overflow: unless a bound of the result is finite, it's computed aside first
+    if (isinf(kernels::maxAbs(y->getData(), dim) + fabs(alpha) * kernels::maxAbs(x->getData(), dim))) {
+        vector<double> res(y->getData(), y->getData() + dim);
+        kernels::axpy(res.data(), alpha, x->getData(), dim);
+        if (!kernels::isFinite(res.data(), dim)) {
+            SendWarning(Vector::getLogger(), RC::INFINITY_OVERFLOW);
+            return RC::INFINITY_OVERFLOW;
+        }
+        memcpy((double*)y->getData(), res.data(), dim * sizeof(double));
+        return RC::SUCCESS;
+    }
+#endif
+    kernels::axpy((double*)y->getData(), alpha, x->getData(), y->getDim());
+    return RC::SUCCESS;
+}
+
+RC IVector::lerp(IVector* const dest, IVector const* const& op1, IVector const* const& op2, double t) {
+#ifndef FAST_MATH
+    if (!sameDim(dest, op1, op2)) {
+        SendWarning(Vector::getLogger(), RC::MISMATCHING_DIMENSIONS);
+        return RC::MISMATCHING_DIMENSIONS;
+    }
+    if (isnan(t) || isinf(t)) {
+        SendWarning(Vector::getLogger(), RC::INVALID_ARGUMENT);
+        return RC::INVALID_ARGUMENT;
+    }
+    size_t dim = dest->getDim();
+    double max1 = kernels::maxAbs(op1->getData(), dim);
+    // same as for axpy(), the bound covers op2 - op1 as well
+    if (isinf(max1 + fabs(t) * (max1 + kernels::maxAbs(op2->getData(), dim)))) {
+        vector<double> res(dim);
+        kernels::lerp(res.data(), op1->getData(), op2->getData(), t, dim);
+        if (!kernels::isFinite(res.data(), dim)) {
+            SendWarning(Vector::getLogger(), RC::INFINITY_OVERFLOW);
+            return RC::INFINITY_OVERFLOW;
+        }
+        memcpy((double*)dest->getData(), res.data(), dim * sizeof(double));
+        return RC::SUCCESS;
+    }
+#endif
+    kernels::lerp((double*)dest->getData(), op1->getData(), op2->getData(), t, dest->getDim());
+    return RC::SUCCESS;
+}
+
+double IVector::distance(IVector const* const& op1, IVector const* const& op2, NORM n) {
+    return distance(IVectorView(op1), IVectorView(op2), n);
+}
+
+double IVector::distance(IVectorView const& op1, IVectorView const& op2, NORM n) {
+#ifndef FAST_MATH
+    if (op1.getDim() != op2.getDim()) {
+        SendWarning(Vector::getLogger(), RC::MISMATCHING_DIMENSIONS);
+        return NAN;
+    }
+#endif
+    if (n >= NORM::AMOUNT) {
+        SendWarning(Vector::getLogger(), RC::INVALID_ARGUMENT);
+        return NAN;
+    }
+    double res = kernels::distance(op1.getData(), op2.getData(), op1.getDim(), n);
+#ifndef FAST_MATH
+    if (isinf(res)) {
+        SendWarning(Vector::getLogger(), RC::INFINITY_OVERFLOW);
+        return NAN;
+    }
+#endif
+    return res;
+}
+
+double IVector::dot(IVectorView const& op1, IVectorView const& op2) {
+#ifndef FAST_MATH
+    if (op1.getDim() != op2.getDim()) {
+        SendWarning(Vector::getLogger(), RC::MISMATCHING_DIMENSIONS);
+        return NAN;
+    }
+#endif
+    double res = kernels::dot(op1.getData(), op2.getData(), op1.getDim());
+#ifndef FAST_MATH
+    if (isinf(res)) {
+        SendWarning(Vector::getLogger(), RC::INFINITY_OVERFLOW);
+        return NAN;
+    }
+#endif
+    return res;
+}
+
+bool IVector::equals(IVectorView const& op1, IVectorView const& op2, NORM n, double tol) {
+    if (op1.getDim() != op2.getDim()) {
+        SendWarning(Vector::getLogger(), RC::MISMATCHING_DIMENSIONS);
+        return false;
+    }
+    if (n >= NORM::AMOUNT) {
+        SendWarning(Vector::getLogger(), RC::INVALID_ARGUMENT);
+        return false;
+    }
+    // distances past tol are cut short, NaN compares false
+    return kernels::distance(op1.getData(), op2.getData(), op1.getDim(), n, tol) < tol;
 }
 
 IVector::~IVector() = default;
+
+IVectorView::IVectorView() {
+    _dim = 0;
+    _data = nullptr;
+}
+
+IVectorView::IVectorView(size_t dim, double const* data) {
+    _dim = dim;
+    _data = data;
+}
+
+IVectorView::IVectorView(IVector const* vector) {
+    _dim = vector->getDim();
+    _data = vector->getData();
+}
+
+double const* IVectorView::getData() const {
+    return _data;
+}
+
+size_t IVectorView::getDim() const {
+    return _dim;
+}
+
+RC IVectorView::getCord(size_t index, double& val) const {
+#ifndef FAST_MATH
+    if (index >= _dim) {
+        return RC::INDEX_OUT_OF_BOUND;
+    }
+#endif
+    val = _data[index];
+    return RC::SUCCESS;
+}
+
+double IVectorView::norm(IVector::NORM n) const {
+    if (n >= IVector::NORM::AMOUNT) {
+        SendWarning(Vector::getLogger(), RC::INVALID_ARGUMENT);
+        return NAN;
+    }
+    double res = kernels::norm(_data, _dim, n);
+#ifndef FAST_MATH
+    if (isinf(res)) {
+        SendWarning(Vector::getLogger(), RC::INFINITY_OVERFLOW);
+        return NAN;
+    }
+#endif
+    return res;
+}
+
+IVector* IVectorView::clone() const {
+    return IVector::createVector(_dim, _data);
+}
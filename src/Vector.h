@@ -1,20 +1,36 @@
 #pragma once
+#include <atomic>
 #include "../include/IVector.h"
 
 namespace {
 
 class Vector : public IVector {
 private:
+    /*
+    * Precedes every instance in memory, so that delete knows where the memory came from
+    */
+    struct alignas(16) Header {
+        IAllocator* allocator;
+        size_t size;
+    };
+
     size_t _dim;
-    static ILogger* _logger;
+    static std::atomic<ILogger*> _logger;
     inline double* getDataArray();
+    inline Header* getHeader() const;
 public:
-    static Vector* createVector(size_t dim, double const* const& pData);
+    static Vector* createVector(size_t dim, double const* const& pData, IAllocator* allocator);
+    static void operator delete(void* ptr);
     virtual IVector* clone() const override;
     virtual double const* getData() const override;
 
     static RC setLogger(ILogger* const logger);
 
+    /*
+    * Logger of the calling thread if it has one, the process-wide one otherwise
+    */
+    static ILogger* getLogger();
+
     virtual RC getCord(size_t index, double& val) const override;
     virtual RC setCord(size_t index, double val) override;
     virtual RC scale(double multiplier) override;
@@ -1,9 +1,313 @@
+#include <atomic>
+#include <cmath>
 #include <iostream>
 #include <limits>
+#include <random>
+#include <thread>
+#include <vector>
 #include "../include/IVector.h"
+#include "../include/ISet.h"
 
 using namespace std;
 
+static int failures = 0;
+
+static void check(bool condition, const char* what) {
+    if (!condition) {
+        failures++;
+        cout << "FAILED: " << what << endl;
+    }
+}
+
+static bool closeToAny(ISet const* set, IVector const* vec, IVector::NORM n, double tol) {
+    for (size_t i = 0; i < set->getSize(); i++) {
+        IVector const* member = nullptr;
+        set->get(i, member);
+        bool close = IVector::distance(vec, member, n) < tol;
+        delete member;
+        if (close) {
+            return true;
+        }
+    }
+    return false;
+}
+
+/*
+* Set algebra spelled out over linear sets: members of src, in order, that are (matched) or aren't close to a
+* member of other, or all of them without other
+*/
+static void insertFiltered(ISet* res, ISet const* src, ISet const* other, bool matched, IVector::NORM n, double tol) {
+    for (size_t i = 0; i < src->getSize(); i++) {
+        IVector const* vec = nullptr;
+        src->get(i, vec);
+        if (!other || closeToAny(other, vec, n, tol) == matched) {
+            res->insert(vec, n, tol);
+        }
+        delete vec;
+    }
+}
+
+static bool isSubSet(ISet const* op1, ISet const* op2, IVector::NORM n, double tol) {
+    for (size_t i = 0; i < op1->getSize(); i++) {
+        IVector const* vec = nullptr;
+        op1->get(i, vec);
+        bool close = closeToAny(op2, vec, n, tol);
+        delete vec;
+        if (!close) {
+            return false;
+        }
+    }
+    return true;
+}
+
+static bool sameMembers(ISet const* res, ISet const* expected) {
+    if (!res || res->getSize() != expected->getSize()) {
+        return false;
+    }
+    for (size_t i = 0; i < res->getSize(); i++) {
+        IVector const* vec1 = nullptr;
+        IVector const* vec2 = nullptr;
+        res->get(i, vec1);
+        expected->get(i, vec2);
+        bool same = IVector::distance(vec1, vec2, IVector::NORM::CHEBYSHEV) == 0;
+        delete vec1;
+        delete vec2;
+        if (!same) {
+            return false;
+        }
+    }
+    return true;
+}
+
+static ISet* linearSet() {
+    ISet* set = ISet::createSet(nullptr);
+    set->setIndex(ISet::INDEX::LINEAR);
+    return set;
+}
+
+/*
+* Every operation against the reference, for all norms, on points of a grid with step tol, so that many pairs are
+* exactly tol apart, and for empty operands
+*/
+static void checkSetAlgebra() {
+    mt19937_64 random(1);
+    uniform_int_distribution<int> step(0, 12);
+    uniform_real_distribution<double> jitter(-0.01, 0.01);
+    for (int n = 0; n < (int)IVector::NORM::AMOUNT; n++) {
+        IVector::NORM norm = (IVector::NORM)n;
+        // vectors exactly tol apart aren't close, ones just under tol are
+        for (double offset : { 0.25, nextafter(0.25, 0.0) }) {
+            double origin[] = { 0, 0 };
+            double shifted[] = { 0, offset };
+            ISet* set1 = ISet::createSet(nullptr);
+            ISet* set2 = ISet::createSet(nullptr);
+            IVector const* vec1 = IVector::createVector(2, origin);
+            IVector const* vec2 = IVector::createVector(2, shifted);
+            set1->insert(vec1, norm, 0.25);
+            set2->insert(vec2, norm, 0.25);
+            bool close = offset < 0.25;
+            ISet* inter = ISet::makeIntersection(set1, set2, norm, 0.25);
+            ISet* uni = ISet::makeUnion(set1, set2, norm, 0.25);
+            check(inter && inter->getSize() == (close ? 1 : 0), "makeIntersection() at distance tol");
+            check(uni && uni->getSize() == (close ? 1 : 2), "makeUnion() at distance tol");
+            check(ISet::subSet(set1, set2, norm, 0.25) == close, "subSet() at distance tol");
+            check(ISet::equals(set1, set2, norm, 0.25) == close, "equals() at distance tol");
+            delete inter;
+            delete uni;
+            delete vec1;
+            delete vec2;
+            delete set1;
+            delete set2;
+        }
+        for (double tol : { 0.25, 0.26 }) {
+            for (int empty = 0; empty < 4; empty++) {
+                ISet* ops[] = { ISet::createSet(nullptr), ISet::createSet(nullptr) };
+                for (int k = 0; k < 2; k++) {
+                    size_t count = (empty >> k & 1) ? 0 : 300;
+                    for (size_t i = 0; i < count; i++) {
+                        double cords[] = { step(random) * 0.25, step(random) * 0.25 + (i % 4 == 0 ? jitter(random) : 0) };
+                        IVector const* vec = IVector::createVector(2, cords);
+                        ops[k]->insert(vec, norm, i % 3 == 0 ? 0.1 : tol);
+                        delete vec;
+                    }
+                }
+                ISet* expected[] = { linearSet(), linearSet(), linearSet(), linearSet() };
+                insertFiltered(expected[0], ops[0], ops[1], true, norm, tol);
+                insertFiltered(expected[1], ops[0], nullptr, true, norm, tol);
+                insertFiltered(expected[1], ops[1], nullptr, true, norm, tol);
+                insertFiltered(expected[2], ops[0], ops[1], false, norm, tol);
+                insertFiltered(expected[3], ops[0], ops[1], false, norm, tol);
+                insertFiltered(expected[3], ops[1], ops[0], false, norm, tol);
+                ISet* res[] = {
+                    ISet::makeIntersection(ops[0], ops[1], norm, tol),
+                    ISet::makeUnion(ops[0], ops[1], norm, tol),
+                    ISet::sub(ops[0], ops[1], norm, tol),
+                    ISet::symSub(ops[0], ops[1], norm, tol)
+                };
+                check(sameMembers(res[0], expected[0]), "makeIntersection()");
+                check(sameMembers(res[1], expected[1]), "makeUnion()");
+                check(sameMembers(res[2], expected[2]), "sub()");
+                check(sameMembers(res[3], expected[3]), "symSub()");
+                bool sub12 = isSubSet(ops[0], ops[1], norm, tol);
+                bool sub21 = isSubSet(ops[1], ops[0], norm, tol);
+                check(ISet::subSet(ops[0], ops[1], norm, tol) == sub12, "subSet()");
+                check(ISet::subSet(expected[0], ops[0], norm, tol), "subSet() of the intersection");
+                check(ISet::equals(ops[0], ops[1], norm, tol) == (sub12 && sub21), "equals()");
+                check(ISet::equals(ops[0], ops[0], norm, tol), "equals() of a set to itself");
+                for (int k = 0; k < 4; k++) {
+                    delete res[k];
+                    delete expected[k];
+                }
+                delete ops[0];
+                delete ops[1];
+            }
+        }
+    }
+}
+
+/*
+* One writer appends vectors (v, v, v) for consecutive v and removes the oldest ones, so the set always holds a run
+* of consecutive values in ascending order, between minSize and maxSize of them. `readers` threads check meanwhile
+* that every call sees such a run and that vectors found by pattern are stored exactly
+*/
+static void stressConcurrentSet(size_t readers) {
+    constexpr size_t minSize = 64;
+    constexpr size_t maxSize = 256;
+    constexpr size_t writes = 600;
+    ISet* set = ISet::createConcurrentSet(nullptr);
+    auto insertValue = [set](size_t value) {
+        double cords[] = { (double)value, (double)value, (double)value };
+        IVector const* vec = IVector::createVector(3, cords);
+        RC code = set->insert(vec, IVector::NORM::CHEBYSHEV, 0.5);
+        delete vec;
+        return code == RC::SUCCESS;
+    };
+    size_t first = 0;
+    size_t next = 0;
+    while (next < minSize) {
+        insertValue(next++);
+    }
+
+    atomic<bool> done(false);
+    atomic<size_t> started(0);
+    atomic<size_t> inconsistent(0);
+    vector<thread> threads;
+    for (size_t r = 0; r < readers; r++) {
+        threads.emplace_back([&, r] {
+            mt19937_64 random(r);
+            double origin[] = { 0, 0, 0 };
+            IVector const* pat = IVector::createVector(3, origin);
+            vector<size_t> indices;
+            vector<double> dists;
+            size_t reads = 0;
+            started++;
+            while (!done) {
+                size_t size = set->getSize();
+                if (size < minSize || size > maxSize) {
+                    inconsistent++;
+                }
+                // one call reads one replica: the whole run, nearest to the origin first
+                set->findKNearest(pat, IVector::NORM::CHEBYSHEV, maxSize + 1, indices, dists);
+                bool run = indices.size() >= minSize && indices.size() <= maxSize && dists.size() == indices.size();
+                for (size_t i = 0; run && i < indices.size(); i++) {
+                    run = indices[i] == i && dists[i] == dists[0] + (double)i;
+                }
+                if (!run) {
+                    inconsistent++;
+                }
+                double value = (double)(random() % (writes + minSize));
+                double cords[] = { value, value, value };
+                IVector const* probe = IVector::createVector(3, cords);
+                IVector const* found = nullptr;
+                if (set->findFirst(probe, IVector::NORM::CHEBYSHEV, 0.5, found) == RC::SUCCESS
+                    && IVector::distance(found, probe, IVector::NORM::CHEBYSHEV) != 0) {
+                    inconsistent++;
+                }
+                delete found;
+                delete probe;
+                // lets the writer in on machines with fewer cores than threads, rarely enough that readers are
+                // still preempted in the middle of calls
+                if (++reads % 8 == 0) {
+                    this_thread::yield();
+                }
+            }
+            delete pat;
+        });
+    }
+
+    while (started < readers) {
+        this_thread::yield();
+    }
+    bool growing = true;
+    size_t failedWrites = 0;
+    for (size_t i = 0; i < writes; i++) {
+        growing = growing ? next - first < maxSize : next - first <= minSize;
+        if (growing) {
+            failedWrites += insertValue(next++) ? 0 : 1;
+        } else {
+            failedWrites += set->remove(0) == RC::SUCCESS ? 0 : 1;
+            first++;
+        }
+        this_thread::yield();
+    }
+    done = true;
+    for (thread& reader : threads) {
+        reader.join();
+    }
+    check(failedWrites == 0, "ConcurrentSet writes");
+    check(inconsistent == 0, "ConcurrentSet reads alongside a writer");
+    bool kept = set->getSize() == next - first;
+    for (size_t i = 0; kept && i < set->getSize(); i++) {
+        IVector const* vec = nullptr;
+        double cord = -1;
+        kept = set->get(i, vec) == RC::SUCCESS && vec->getCord(0, cord) == RC::SUCCESS && cord == (double)(first + i);
+        delete vec;
+    }
+    check(kept, "ConcurrentSet contents after the writer");
+    delete set;
+}
+
+static void checkPoolAllocator() {
+    // 1000 doubles are above the largest pooled block, so they come straight from the heap
+    vector<double> data(1000, 1.0);
+    IAllocator* pool = IAllocator::createPool();
+    size_t empty = pool->sizeAllocated();
+    IVector* freed = IVector::createVector(data.size(), data.data(), pool);
+    check(freed && pool->sizeAllocated() > empty + data.size() * sizeof(double), "large block of the pool allocator");
+    delete freed;
+    check(pool->sizeAllocated() == empty, "large block of the pool allocator freed on delete");
+    IVector* dropped = IVector::createVector(data.size(), data.data(), pool);
+    IVector* kept = IVector::createVector(data.size(), data.data(), pool);
+    check(dropped && kept && pool->sizeAllocated() > empty, "large blocks of the pool allocator");
+    pool->reset();
+    check(pool->sizeAllocated() == empty, "large blocks of the pool allocator freed on reset()");
+    delete pool;
+}
+
+static void checkBatchArguments() {
+    double row[] = { 1, 2, 3 };
+    size_t reads = 0;
+    ISet::RowReader once = [&](double* rows, size_t) -> size_t {
+        if (reads++ > 0) {
+            return 0;
+        }
+        copy(begin(row), end(row), rows);
+        return 1;
+    };
+    // both kinds of set reject the same arguments with the same codes
+    for (ISet* set : { ISet::createSet(nullptr), ISet::createConcurrentSet(nullptr) }) {
+        check(set->insertBatch(row, 0, 1, IVector::NORM::SECOND, 0.1) == RC::INVALID_ARGUMENT, "insertBatch() with dim 0");
+        check(set->insertStream(once, 0, IVector::NORM::SECOND, 0.1) == RC::INVALID_ARGUMENT, "insertStream() with dim 0");
+        check(set->insertStream(nullptr, 3, IVector::NORM::SECOND, 0.1) == RC::NULLPTR_ERROR, "insertStream() without a reader");
+        check(set->insertStream([](double*, size_t capacity) { return capacity + 1; }, 3, IVector::NORM::SECOND, 0.1) == RC::INVALID_ARGUMENT,
+            "insertStream() reading more than asked");
+        check(set->getSize() == 0, "set after rejected batches");
+        reads = 0;
+        check(set->insertStream(once, 3, IVector::NORM::SECOND, 0.1) == RC::SUCCESS && set->getSize() == 1, "insertStream()");
+        delete set;
+    }
+}
+
 int main() {
     double data1[] = { 1, 2, 3 };
     double data2[] = { -1, -2, -3 };
@@ -60,8 +364,45 @@ int main() {
     vec1 = IVector::createVector(3, data1);
 
     cout << "\nIVector::createVector() returned " << vec1 << endl;
-    cout << "\nTest is finished" << endl;
+
+    cout << "\nSet algebra on {(0,0), (1,0), (0,1)} and {(0,0.05), (1,1)} with tol = 0.1" << endl;
+    double points[][2] = { { 0, 0 }, { 1, 0 }, { 0, 1 }, { 0, 0.05 }, { 1, 1 } };
+    const char* normNames[] = { "CHEBYSHEV", "FIRST", "SECOND" };
+    for (int n = 0; n < (int)IVector::NORM::AMOUNT; n++) {
+        IVector::NORM norm = (IVector::NORM)n;
+        ISet* set1 = ISet::createSet(logger);
+        ISet* set2 = ISet::createSet(logger);
+        for (int i = 0; i < 5; i++) {
+            const IVector* point = IVector::createVector(2, points[i]);
+            (i < 3 ? set1 : set2)->insert(point, norm, 0.1);
+            delete point;
+        }
+        ISet* inter = ISet::makeIntersection(set1, set2, norm, 0.1);
+        ISet* uni = ISet::makeUnion(set1, set2, norm, 0.1);
+        ISet* diff = ISet::sub(set1, set2, norm, 0.1);
+        ISet* symDiff = ISet::symSub(set1, set2, norm, 0.1);
+        cout << normNames[n] << ": |A & B| = " << inter->getSize() << ", |A | B| = " << uni->getSize()
+            << ", |A \\ B| = " << diff->getSize() << ", |A ^ B| = " << symDiff->getSize()
+            << ", A & B <= A: " << ISet::subSet(inter, set1, norm, 0.1)
+            << ", A == B: " << ISet::equals(set1, set2, norm, 0.1) << endl;
+        delete inter;
+        delete uni;
+        delete diff;
+        delete symDiff;
+        delete set1;
+        delete set2;
+    }
+    checkPoolAllocator();
+    checkBatchArguments();
+    checkSetAlgebra();
+    // with a thread pool, so that readers scanning in parallel are covered as well
+    ISet::setThreadCount(4);
+    for (size_t readers : { 1, 4, 16 }) {
+        stressConcurrentSet(readers);
+    }
+    ISet::setThreadCount(1);
+    cout << "\nTest is finished, " << failures << " checks failed" << endl;
 
     delete logger;
-    return 0;
+    return failures == 0 ? 0 : 1;
 }
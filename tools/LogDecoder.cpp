@@ -0,0 +1,117 @@
+#include <cinttypes>
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <vector>
+#include "../src/BinaryLogFormat.h"
+#include "../src/Logger.h"
+
+/*
+* Turns a log written by ILogger::createBinaryLogger() into text or JSON lines
+*
+* Usage: log_decoder <file> [--json]
+*/
+
+struct Site {
+    std::string file;
+    std::string function;
+    uint32_t line;
+};
+
+static std::string escape(const std::string& text) {
+    std::string res;
+    for (char c : text) {
+        if (c == '"' || c == '\\') {
+            res += '\\';
+            res += c;
+        } else if ((unsigned char)c < 0x20) {
+            char code[8];
+            snprintf(code, sizeof(code), "\\u%04x", c);
+            res += code;
+        } else {
+            res += c;
+        }
+    }
+    return res;
+}
+
+static const char* levelOf(uint8_t level) {
+    return level <= (uint8_t)ILogger::Level::INFO ? Logger::getLevel((ILogger::Level)level) : "UNKNOWN";
+}
+
+static const char* messageOf(uint16_t code) {
+    return code < (uint16_t)RC::AMOUNT ? Logger::getMessage((RC)code) : Logger::getMessage(RC::UNKNOWN);
+}
+
+static void print(const binlog::Record& record, Site const* site, bool json) {
+    if (json) {
+        printf("{\"time_ns\":%" PRIu64 ",\"thread\":%" PRIu32 ",\"level\":\"%s\",\"code\":%u,\"message\":\"%s\"",
+            record.time, record.thread, levelOf(record.level), (unsigned)record.code, messageOf(record.code));
+        if (site) {
+            printf(",\"file\":\"%s\",\"line\":%" PRIu32 ",\"function\":\"%s\"",
+                escape(site->file).c_str(), site->line, escape(site->function).c_str());
+        }
+        printf("}\n");
+        return;
+    }
+    printf("+%" PRIu64 ".%09" PRIu64 " [thread %" PRIu32 "] %s: %s", record.time / 1000000000, record.time % 1000000000,
+        record.thread, levelOf(record.level), messageOf(record.code));
+    if (site) {
+        printf(" (%s:%" PRIu32 ", %s)", site->file.c_str(), site->line, site->function.c_str());
+    }
+    printf("\n");
+}
+
+int main(int argc, char** argv) {
+    if (argc < 2 || (argc == 3 && strcmp(argv[2], "--json") != 0) || argc > 3) {
+        fprintf(stderr, "Usage: %s <file> [--json]\n", argv[0]);
+        return 2;
+    }
+    bool json = argc == 3;
+    FILE* file = fopen(argv[1], "rb");
+    if (!file) {
+        fprintf(stderr, "%s: %s\n", Logger::getMessage(RC::FILE_NOT_FOUND), argv[1]);
+        return 1;
+    }
+
+    binlog::Header header;
+    if (fread(&header, sizeof(header), 1, file) != 1 || memcmp(header.magic, binlog::magic, sizeof(header.magic)) != 0 ||
+        header.version != binlog::version || header.recordSize != sizeof(binlog::Record)) {
+        fprintf(stderr, "%s: not a binary log of version %" PRIu32 "\n", argv[1], binlog::version);
+        fclose(file);
+        return 1;
+    }
+    if (!json) {
+        printf("Started at %" PRId64 ".%09" PRId64 " (Unix time)\n", header.startRealtime / 1000000000, header.startRealtime % 1000000000);
+    }
+
+    std::vector<Site> sites(1);
+    binlog::Record record;
+    while (fread(&record, sizeof(record), 1, file) == 1) {
+        switch ((binlog::Kind)record.kind) {
+        case binlog::Kind::SITE: {
+            size_t length = (size_t)record.fileLength + record.functionLength;
+            size_t padded = (length + sizeof(binlog::Record) - 1) / sizeof(binlog::Record) * sizeof(binlog::Record);
+            std::string text(padded, '\0');
+            if (padded > 0 && fread(&text[0], padded, 1, file) != 1) {
+                break;
+            }
+            if (sites.size() <= record.site) {
+                sites.resize(record.site + 1);
+            }
+            sites[record.site] = { text.substr(0, record.fileLength), text.substr(record.fileLength, record.functionLength), record.line };
+            break;
+        }
+        case binlog::Kind::RECORD:
+            print(record, record.site != 0 && record.site < sites.size() ? &sites[record.site] : nullptr, json);
+            break;
+        default:
+            break;
+        }
+    }
+    if (header.dropped > 0) {
+        fprintf(stderr, "%" PRIu64 " records were dropped, the log was full\n", header.dropped);
+    }
+    fclose(file);
+    return 0;
+}